@@ -0,0 +1,325 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+// Measures the cost of handing tasks over to an active thread:
+//   post_latency: from PostTask() to the task starting on an idle executor.
+//   ping_pong:    a round trip between two executors posting to each other.
+//   throughput:   N producer threads post tasks as fast as possible; also reports the
+//                 enqueue-to-execute latency under such load.
+// Usage:
+//   active-thread-bench [--executor=active|io] [--iterations=N] [--producers=N]
+//                       [--pin] [--json]
+// With --pin, every thread involved is pinned to its own CPU, in round-robin.
+// With --json, each result is printed as one JSON object per line.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "benchmark_harness.h"
+
+#include "active_thread.h"
+#include "io_active_thread.h"
+
+namespace {
+
+using bench::Clock;
+using bench::ElapsedNanoseconds;
+
+struct Options {
+    std::string executor = "active";
+    size_t iterations = 100000;
+    size_t producers = 4;
+    bool pin = false;
+    bool json = false;
+};
+
+// A one-shot event; notifying under the lock makes it safe for the waiter to destroy the
+// notification as soon as Wait() returns.
+class Notification {
+public:
+    Notification()
+        : notified_(false)
+    {}
+
+    void Notify()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        notified_ = true;
+        cv_.notify_all();
+    }
+
+    void Wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return notified_; });
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool notified_;
+};
+
+// Hands out CPUs in round-robin; does nothing unless pinning is enabled.
+class CpuPinner {
+public:
+    explicit CpuPinner(bool enabled)
+        : enabled_(enabled), next_cpu_(0)
+    {}
+
+    void PinCurrentThread()
+    {
+        if (!enabled_) {
+            return;
+        }
+
+#if defined(__linux__)
+        auto cpu_count = std::max(1u, std::thread::hardware_concurrency());
+        auto cpu = next_cpu_.fetch_add(1, std::memory_order_relaxed) % cpu_count;
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(cpu, &cpu_set);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+#endif
+    }
+
+    // Executors don't expose their threads, thus let them pin themselves.
+    template<typename Executor>
+    void PinExecutor(Executor& executor)
+    {
+        Notification pinned;
+        executor.PostTask([this, &pinned] {
+            PinCurrentThread();
+            pinned.Notify();
+        });
+        pinned.Wait();
+    }
+
+private:
+    bool enabled_;
+    std::atomic<unsigned int> next_cpu_;
+};
+
+class LatencyHistogram {
+public:
+    explicit LatencyHistogram(size_t expected_count)
+    {
+        samples_.reserve(expected_count);
+    }
+
+    void Add(uint64_t nanoseconds)
+    {
+        samples_.push_back(nanoseconds);
+    }
+
+    void Report(const std::string& name, const Options& options, size_t producers,
+                double tasks_per_second)
+    {
+        if (samples_.empty()) {
+            return;
+        }
+
+        std::sort(samples_.begin(), samples_.end());
+        auto mean = std::accumulate(samples_.begin(), samples_.end(), 0.0) / samples_.size();
+        bench::ResultLine line(options.json, name.c_str());
+        line.Add("executor", options.executor)
+            .Add("samples", samples_.size())
+            .Add("producers", producers)
+            .Add("pinned", options.pin)
+            .Add("unit", "ns")
+            .Add("mean", mean)
+            .Add("p50", Percentile(0.5))
+            .Add("p99", Percentile(0.99))
+            .Add("p999", Percentile(0.999))
+            .Add("max", Percentile(1.0));
+        if (tasks_per_second > 0) {
+            line.Add("tasks_per_sec", tasks_per_second);
+        }
+
+        line.Print();
+    }
+
+private:
+    uint64_t Percentile(double ratio) const
+    {
+        auto rank = static_cast<size_t>(ratio * (samples_.size() - 1));
+        return samples_[rank];
+    }
+
+private:
+    std::vector<uint64_t> samples_;
+};
+
+template<typename Executor>
+void RunPostLatency(const Options& options, CpuPinner& pinner)
+{
+    Executor executor;
+    pinner.PinExecutor(executor);
+    pinner.PinCurrentThread();
+
+    LatencyHistogram histogram(options.iterations);
+    std::atomic<bool> executed(false);
+    for (size_t i = 0; i < options.iterations; ++i) {
+        executed.store(false, std::memory_order_relaxed);
+        auto posted_at = Clock::now();
+        executor.PostTask([&histogram, &executed, posted_at] {
+            histogram.Add(ElapsedNanoseconds(posted_at, Clock::now()));
+            executed.store(true, std::memory_order_release);
+        });
+
+        while (!executed.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+
+    histogram.Report("post_latency", options, 1, 0);
+}
+
+template<typename Executor>
+class PingPong {
+public:
+    PingPong(Executor& ping, Executor& pong, size_t rounds)
+        : ping_(ping), pong_(pong), remaining_(rounds), histogram_(rounds)
+    {}
+
+    void Run(const Options& options)
+    {
+        ping_.PostTask([this] {
+            last_seen_ = Clock::now();
+            Serve();
+        });
+        done_.Wait();
+        histogram_.Report("ping_pong", options, 1, 0);
+    }
+
+private:
+    // Always runs on `ping_`.
+    void Serve()
+    {
+        if (remaining_ == 0) {
+            done_.Notify();
+            return;
+        }
+
+        --remaining_;
+        pong_.PostTask([this] {
+            ping_.PostTask([this] {
+                auto now = Clock::now();
+                histogram_.Add(ElapsedNanoseconds(last_seen_, now));
+                last_seen_ = now;
+                Serve();
+            });
+        });
+    }
+
+private:
+    Executor& ping_;
+    Executor& pong_;
+    size_t remaining_;
+    Clock::time_point last_seen_;
+    LatencyHistogram histogram_;
+    Notification done_;
+};
+
+template<typename Executor>
+void RunPingPong(const Options& options, CpuPinner& pinner)
+{
+    Executor ping;
+    Executor pong;
+    pinner.PinExecutor(ping);
+    pinner.PinExecutor(pong);
+    PingPong<Executor>(ping, pong, options.iterations).Run(options);
+}
+
+template<typename Executor>
+void RunThroughput(const Options& options, CpuPinner& pinner)
+{
+    Executor executor;
+    pinner.PinExecutor(executor);
+
+    auto tasks_per_producer = std::max<size_t>(1, options.iterations / options.producers);
+    auto total_tasks = tasks_per_producer * options.producers;
+
+    // All of them are written only on the executor.
+    LatencyHistogram histogram(total_tasks);
+    size_t executed = 0;
+    Clock::time_point finished_at;
+    Notification all_executed;
+
+    auto started_at = bench::RunTogether(static_cast<int>(options.producers), [&](int) {
+        pinner.PinCurrentThread();
+        for (size_t n = 0; n < tasks_per_producer; ++n) {
+            auto posted_at = Clock::now();
+            executor.PostTask([&, posted_at] {
+                auto now = Clock::now();
+                histogram.Add(ElapsedNanoseconds(posted_at, now));
+                if (++executed == total_tasks) {
+                    finished_at = now;
+                    all_executed.Notify();
+                }
+            });
+        }
+    });
+    all_executed.Wait();
+
+    auto seconds = ElapsedNanoseconds(started_at, finished_at) / 1e9;
+    histogram.Report("throughput", options, options.producers, total_tasks / seconds);
+}
+
+template<typename Executor>
+void RunAll(const Options& options)
+{
+    CpuPinner pinner(options.pin);
+    RunPostLatency<Executor>(options, pinner);
+
+    // Every benchmark starts pinning from the first CPU over again.
+    CpuPinner ping_pong_pinner(options.pin);
+    RunPingPong<Executor>(options, ping_pong_pinner);
+
+    CpuPinner throughput_pinner(options.pin);
+    RunThroughput<Executor>(options, throughput_pinner);
+}
+
+}   // namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    bench::FlagParser flags;
+    flags.String("--executor", &options.executor, "active|io")
+         .Number("--iterations", &options.iterations, 1)
+         .Number("--producers", &options.producers, 1)
+         .Switch("--pin", &options.pin)
+         .Switch("--json", &options.json);
+    if (!flags.Parse(argc, argv)) {
+        flags.PrintUsage(argv[0]);
+        return 1;
+    }
+
+    if (options.executor == "active") {
+        RunAll<ActiveThread>(options);
+#if defined(__linux__)
+    } else if (options.executor == "io") {
+        RunAll<IOActiveThread>(options);
+#endif
+    } else {
+        fprintf(stderr, "unsupported executor: %s\n", options.executor.c_str());
+        return 1;
+    }
+
+    return 0;
+}
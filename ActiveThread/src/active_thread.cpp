@@ -7,8 +7,19 @@
 #include <memory>
 #include <thread>
 
+namespace {
+
+constexpr size_t kDefaultStarvationLimit = 8;
+constexpr std::chrono::milliseconds kDefaultIdleTimeSlice(10);
+
+}   // namespace
+
 ActiveThread::ActiveThread()
-    : done_(false)
+    : ActiveThread(kDefaultStarvationLimit, kDefaultIdleTimeSlice)
+{}
+
+ActiveThread::ActiveThread(size_t starvation_limit, std::chrono::milliseconds idle_time_slice)
+    : task_queue_(starvation_limit, idle_time_slice), done_(false)
 {
     thread_ = std::make_unique<std::thread>(&ActiveThread::Run, this);
 }
@@ -24,12 +35,58 @@ void ActiveThread::Run()
 {
     while (!done_) {
         Task task;
-        task_queue_.Dequeue(&task);
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_empty_.wait(lock, [this] { return !task_queue_.empty(); });
+            // Every task left may have been cancelled.
+            if (!task_queue_.Pop(&task)) {
+                continue;
+            }
+        }
+
+        task();
+    }
+
+    // Drains tasks that have lower priority than the quit task.
+    while (true) {
+        Task task;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!task_queue_.PopTask(&task)) {
+                break;
+            }
+        }
+
         task();
     }
 }
 
 void ActiveThread::PostTask(Task&& task)
 {
-    task_queue_.Enqueue(task);
+    PostTask(TaskPriority::NORMAL, std::move(task));
+}
+
+void ActiveThread::PostTask(TaskPriority priority, Task&& task)
+{
+    PostTask(priority, std::move(task), CancellationToken());
+}
+
+void ActiveThread::PostTask(TaskPriority priority, Task&& task, CancellationToken token)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_queue_.Push(priority, std::move(task), std::move(token));
+    }
+
+    not_empty_.notify_one();
+}
+
+void ActiveThread::PostIdleTask(IdleTask&& task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_queue_.PushIdle(std::move(task));
+    }
+
+    not_empty_.notify_one();
 }
@@ -9,34 +9,51 @@
 #ifndef EUREKA_ACTIVE_THREAD_ACTIVE_THREAD_H_
 #define EUREKA_ACTIVE_THREAD_ACTIVE_THREAD_H_
 
-#include <functional>
+#include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 
-#include "blocking_queue.h"
+#include "basic_macros.h"
+#include "task_queue.h"
 
 namespace std {
 class thread;
 }
 
-using Task = std::function<void()>;
-
 class ActiveThread {
 public:
     ActiveThread();
 
+    // See `TaskQueue` for the meaning of `starvation_limit`.
+    // `idle_time_slice` decides the deadline hint an idle task receives when it starts.
+    ActiveThread(size_t starvation_limit, std::chrono::milliseconds idle_time_slice);
+
+    // Tasks posted before destruction still run; pending idle tasks are discarded.
     ~ActiveThread();
 
     DISALLOW_COPY(ActiveThread);
 
     DISALLOW_MOVE(ActiveThread);
 
+    // Posts the task in normal priority.
     void PostTask(Task&& task);
 
+    void PostTask(TaskPriority priority, Task&& task);
+
+    // The task is skipped if `token` has been cancelled by the time it is dequeued.
+    void PostTask(TaskPriority priority, Task&& task, CancellationToken token);
+
+    // Idle tasks run only when there is no pending task in any priority.
+    void PostIdleTask(IdleTask&& task);
+
 private:
     void Run();
 
 private:
-    BlockingQueue<Task> task_queue_;
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    TaskQueue task_queue_;
     bool done_;
     std::unique_ptr<std::thread> thread_;
 };
@@ -0,0 +1,38 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#include "active_thread_pool.h"
+
+#include <cassert>
+
+ActiveThreadPool::ActiveThreadPool(size_t thread_count)
+    : next_worker_(0)
+{
+    assert(thread_count > 0);
+    workers_.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        workers_.push_back(std::make_unique<ActiveThread>());
+    }
+}
+
+void ActiveThreadPool::PostTask(Task&& task)
+{
+    NextWorker().PostTask(std::move(task));
+}
+
+void ActiveThreadPool::PostTask(TaskPriority priority, Task&& task)
+{
+    NextWorker().PostTask(priority, std::move(task));
+}
+
+void ActiveThreadPool::PostTask(TaskPriority priority, Task&& task, CancellationToken token)
+{
+    NextWorker().PostTask(priority, std::move(task), std::move(token));
+}
+
+ActiveThread& ActiveThreadPool::NextWorker()
+{
+    auto index = next_worker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+    return *workers_[index];
+}
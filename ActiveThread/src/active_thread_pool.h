@@ -0,0 +1,49 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+#ifndef EUREKA_ACTIVE_THREAD_ACTIVE_THREAD_POOL_H_
+#define EUREKA_ACTIVE_THREAD_ACTIVE_THREAD_POOL_H_
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "active_thread.h"
+#include "basic_macros.h"
+
+// A fixed set of active threads; tasks are distributed among them in round-robin.
+class ActiveThreadPool {
+public:
+    explicit ActiveThreadPool(size_t thread_count);
+
+    ~ActiveThreadPool() = default;
+
+    DISALLOW_COPY(ActiveThreadPool);
+
+    DISALLOW_MOVE(ActiveThreadPool);
+
+    void PostTask(Task&& task);
+
+    void PostTask(TaskPriority priority, Task&& task);
+
+    void PostTask(TaskPriority priority, Task&& task, CancellationToken token);
+
+    size_t size() const noexcept
+    {
+        return workers_.size();
+    }
+
+private:
+    ActiveThread& NextWorker();
+
+private:
+    std::vector<std::unique_ptr<ActiveThread>> workers_;
+    std::atomic<size_t> next_worker_;
+};
+
+#endif  // EUREKA_ACTIVE_THREAD_ACTIVE_THREAD_POOL_H_
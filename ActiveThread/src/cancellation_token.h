@@ -0,0 +1,73 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+#ifndef EUREKA_ACTIVE_THREAD_CANCELLATION_TOKEN_H_
+#define EUREKA_ACTIVE_THREAD_CANCELLATION_TOKEN_H_
+
+#include <atomic>
+#include <memory>
+
+#include "basic_macros.h"
+
+// A token observes the cancellation of the source it comes from.
+// A default constructed token is never cancelled.
+class CancellationToken {
+public:
+    CancellationToken() = default;
+
+    bool IsCancelled() const noexcept
+    {
+        return flag_ && flag_->load(std::memory_order_acquire);
+    }
+
+private:
+    friend class CancellationTokenSource;
+
+    explicit CancellationToken(std::shared_ptr<const std::atomic<bool>> flag)
+        : flag_(std::move(flag))
+    {}
+
+private:
+    std::shared_ptr<const std::atomic<bool>> flag_;
+};
+
+// All tokens handed out by a source form a group, and are cancelled at once by `Cancel()`.
+// Tasks posted with a cancelled token are dropped when they are dequeued; a running task
+// can check its token to stop early.
+class CancellationTokenSource {
+public:
+    CancellationTokenSource()
+        : flag_(std::make_shared<std::atomic<bool>>(false))
+    {}
+
+    ~CancellationTokenSource() = default;
+
+    DISALLOW_COPY(CancellationTokenSource);
+
+    DISALLOW_MOVE(CancellationTokenSource);
+
+    void Cancel() noexcept
+    {
+        flag_->store(true, std::memory_order_release);
+    }
+
+    bool IsCancelled() const noexcept
+    {
+        return flag_->load(std::memory_order_acquire);
+    }
+
+    CancellationToken token() const
+    {
+        return CancellationToken(flag_);
+    }
+
+private:
+    std::shared_ptr<std::atomic<bool>> flag_;
+};
+
+#endif  // EUREKA_ACTIVE_THREAD_CANCELLATION_TOKEN_H_
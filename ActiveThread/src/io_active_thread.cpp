@@ -0,0 +1,273 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#include "io_active_thread.h"
+
+#if defined(__linux__)
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <exception>
+#include <system_error>
+#include <thread>
+
+namespace {
+
+constexpr size_t kDefaultStarvationLimit = 8;
+constexpr std::chrono::milliseconds kDefaultIdleTimeSlice(10);
+
+// Caps tasks run between two polls, so that ready file descriptors are not kept waiting.
+constexpr int kMaxTasksPerPoll = 64;
+constexpr int kMaxEventsPerPoll = 64;
+
+void ThrowLastError(const char* what)
+{
+    throw std::system_error(errno, std::system_category(), what);
+}
+
+}   // namespace
+
+IOActiveThread::IOActiveThread()
+    : IOActiveThread(kDefaultStarvationLimit, kDefaultIdleTimeSlice)
+{}
+
+IOActiveThread::IOActiveThread(size_t starvation_limit,
+                               std::chrono::milliseconds idle_time_slice)
+    : task_queue_(starvation_limit, idle_time_slice),
+      epoll_fd_(-1),
+      wakeup_fd_(-1),
+      done_(false)
+{
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ == -1) {
+        ThrowLastError("epoll_create1");
+    }
+
+    wakeup_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wakeup_fd_ == -1) {
+        auto error = errno;
+        close(epoll_fd_);
+        throw std::system_error(error, std::system_category(), "eventfd");
+    }
+
+    epoll_event event {};
+    event.events = EPOLLIN;
+    event.data.fd = wakeup_fd_;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &event) == -1) {
+        auto error = errno;
+        close(wakeup_fd_);
+        close(epoll_fd_);
+        throw std::system_error(error, std::system_category(), "epoll_ctl");
+    }
+
+    thread_ = std::make_unique<std::thread>(&IOActiveThread::Run, this);
+}
+
+IOActiveThread::~IOActiveThread()
+{
+    auto quit_task = [this] { done_ = true; };
+    PostTask(std::move(quit_task));
+    thread_->join();
+
+    close(wakeup_fd_);
+    close(epoll_fd_);
+}
+
+void IOActiveThread::Run()
+{
+    bool has_pending_work = false;
+    while (!done_) {
+        // Never sleeps if there are still tasks to run.
+        int dispatched = DispatchEvents(has_pending_work ? 0 : -1);
+
+        bool ran_tasks = RunPendingTasks();
+        if (!ran_tasks && dispatched == 0 && !done_) {
+            Task idle_task;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                task_queue_.PopIdleTask(&idle_task);
+            }
+
+            if (idle_task) {
+                idle_task();
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        has_pending_work = !task_queue_.empty();
+    }
+
+    // Drains tasks that have lower priority than the quit task.
+    while (true) {
+        Task task;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!task_queue_.PopTask(&task)) {
+                break;
+            }
+        }
+
+        task();
+    }
+}
+
+int IOActiveThread::DispatchEvents(int timeout_in_ms)
+{
+    epoll_event events[kMaxEventsPerPoll];
+    int ready = epoll_wait(epoll_fd_, events, kMaxEventsPerPoll, timeout_in_ms);
+    if (ready == -1) {
+        if (errno == EINTR) {
+            return 0;
+        }
+
+        ThrowLastError("epoll_wait");
+    }
+
+    int dispatched = 0;
+    for (int i = 0; i < ready; ++i) {
+        int fd = events[i].data.fd;
+        if (fd == wakeup_fd_) {
+            uint64_t count;
+            while (read(wakeup_fd_, &count, sizeof(count)) == -1 && errno == EINTR) {}
+            continue;
+        }
+
+        // A previous callback in this round may have stopped watching this fd.
+        auto it = watchers_.find(fd);
+        if (it == watchers_.end()) {
+            continue;
+        }
+
+        // The callback may stop watching itself.
+        auto callback = it->second;
+        (*callback)(events[i].events);
+        ++dispatched;
+    }
+
+    return dispatched;
+}
+
+bool IOActiveThread::RunPendingTasks()
+{
+    int ran = 0;
+    for (; ran < kMaxTasksPerPoll && !done_; ++ran) {
+        Task task;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!task_queue_.PopTask(&task)) {
+                break;
+            }
+        }
+
+        task();
+    }
+
+    return ran > 0;
+}
+
+void IOActiveThread::Wakeup()
+{
+    uint64_t one = 1;
+    while (write(wakeup_fd_, &one, sizeof(one)) == -1 && errno == EINTR) {}
+}
+
+void IOActiveThread::PostTask(Task&& task)
+{
+    PostTask(TaskPriority::NORMAL, std::move(task));
+}
+
+void IOActiveThread::PostTask(TaskPriority priority, Task&& task)
+{
+    PostTask(priority, std::move(task), CancellationToken());
+}
+
+void IOActiveThread::PostTask(TaskPriority priority, Task&& task, CancellationToken token)
+{
+    bool was_empty;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        was_empty = task_queue_.empty();
+        task_queue_.Push(priority, std::move(task), std::move(token));
+    }
+
+    // The loop never sleeps on a non-empty queue, thus only the first task needs a wakeup.
+    if (was_empty) {
+        Wakeup();
+    }
+}
+
+void IOActiveThread::PostIdleTask(IdleTask&& task)
+{
+    bool was_empty;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        was_empty = task_queue_.empty();
+        task_queue_.PushIdle(std::move(task));
+    }
+
+    if (was_empty) {
+        Wakeup();
+    }
+}
+
+std::future<void> IOActiveThread::WatchFileDescriptor(int fd, uint32_t events,
+                                                      WatchCallback callback)
+{
+    auto watched = std::make_shared<std::promise<void>>();
+    auto result = watched->get_future();
+    if (RunsTasksOnCurrentThread()) {
+        AddWatcher(fd, events, std::move(callback), *watched);
+    } else {
+        // Failures are reported through the future; an exception escaping a task would
+        // terminate the process.
+        PostTask(TaskPriority::HIGH,
+                 [this, fd, events, callback = std::move(callback), watched]() mutable {
+            AddWatcher(fd, events, std::move(callback), *watched);
+        });
+    }
+
+    return result;
+}
+
+void IOActiveThread::AddWatcher(int fd, uint32_t events, WatchCallback&& callback,
+                                std::promise<void>& watched)
+{
+    epoll_event event {};
+    event.events = events;
+    event.data.fd = fd;
+    bool watching = watchers_.count(fd) != 0;
+    if (epoll_ctl(epoll_fd_, watching ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &event) == -1) {
+        watched.set_exception(std::make_exception_ptr(
+            std::system_error(errno, std::system_category(), "epoll_ctl")));
+        return;
+    }
+
+    watchers_[fd] = std::make_shared<WatchCallback>(std::move(callback));
+    watched.set_value();
+}
+
+void IOActiveThread::StopWatchingFileDescriptor(int fd)
+{
+    if (!RunsTasksOnCurrentThread()) {
+        PostTask(TaskPriority::HIGH, [this, fd] { StopWatchingFileDescriptor(fd); });
+        return;
+    }
+
+    if (watchers_.erase(fd) == 0) {
+        return;
+    }
+
+    // The fd may have been closed already, which removes it from the epoll set implicitly.
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+bool IOActiveThread::RunsTasksOnCurrentThread() const
+{
+    return std::this_thread::get_id() == thread_->get_id();
+}
+
+#endif  // __linux__
@@ -0,0 +1,98 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+#ifndef EUREKA_ACTIVE_THREAD_IO_ACTIVE_THREAD_H_
+#define EUREKA_ACTIVE_THREAD_IO_ACTIVE_THREAD_H_
+
+#if defined(__linux__)
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "basic_macros.h"
+#include "task_queue.h"
+
+namespace std {
+class thread;
+}
+
+// An active thread whose loop waits in epoll_wait, so that readiness of file descriptors
+// and posted tasks are dispatched on the same thread.
+// Posted tasks follow the same priority rules as in ActiveThread; idle tasks run only when
+// there is neither pending task nor ready file descriptor.
+class IOActiveThread {
+public:
+    // Receives the ready events, e.g. EPOLLIN | EPOLLHUP.
+    using WatchCallback = std::function<void(uint32_t events)>;
+
+    IOActiveThread();
+
+    IOActiveThread(size_t starvation_limit, std::chrono::milliseconds idle_time_slice);
+
+    // Tasks posted before destruction still run; pending idle tasks are discarded.
+    // File descriptors being watched are not closed.
+    ~IOActiveThread();
+
+    DISALLOW_COPY(IOActiveThread);
+
+    DISALLOW_MOVE(IOActiveThread);
+
+    void PostTask(Task&& task);
+
+    void PostTask(TaskPriority priority, Task&& task);
+
+    // The task is skipped if `token` has been cancelled by the time it is dequeued.
+    void PostTask(TaskPriority priority, Task&& task, CancellationToken token);
+
+    void PostIdleTask(IdleTask&& task);
+
+    // Watching a file descriptor again replaces its events and callback.
+    // If called on other threads, the request is posted to this thread in high priority.
+    // The future returned becomes ready once the request is done; its get() throws
+    // std::system_error if the file descriptor can't be watched.
+    std::future<void> WatchFileDescriptor(int fd, uint32_t events, WatchCallback callback);
+
+    void StopWatchingFileDescriptor(int fd);
+
+    bool RunsTasksOnCurrentThread() const;
+
+private:
+    void Run();
+
+    // Returns the number of ready file descriptors dispatched.
+    int DispatchEvents(int timeout_in_ms);
+
+    // Returns true if any task was run.
+    bool RunPendingTasks();
+
+    void Wakeup();
+
+    // Runs on this thread only.
+    void AddWatcher(int fd, uint32_t events, WatchCallback&& callback,
+                    std::promise<void>& watched);
+
+private:
+    std::mutex mutex_;
+    TaskQueue task_queue_;
+    int epoll_fd_;
+    int wakeup_fd_;
+    // Held by pointer, so that dispatching an event neither copies the callback nor loses it
+    // when the callback stops watching itself.
+    std::unordered_map<int, std::shared_ptr<WatchCallback>> watchers_;
+    bool done_;
+    std::unique_ptr<std::thread> thread_;
+};
+
+#endif  // __linux__
+
+#endif  // EUREKA_ACTIVE_THREAD_IO_ACTIVE_THREAD_H_
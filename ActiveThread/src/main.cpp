@@ -3,18 +3,130 @@
 */
 
 #include <iostream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
 #include <thread>
 
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
+
 #include "active_thread.h"
+#include "active_thread_pool.h"
+#include "io_active_thread.h"
+#include "task_graph.h"
+
+void CancellationDemo()
+{
+    ActiveThread active_handler;
+    CancellationTokenSource request;
+    active_handler.PostTask([] { std::this_thread::sleep_for(std::chrono::milliseconds(100)); });
+    for (int i = 0; i < 3; ++i) {
+        active_handler.PostTask(TaskPriority::NORMAL, [i] {
+            std::cout << "serving abandoned request in the " << i << "th step\n";
+        }, request.token());
+    }
+
+    request.Cancel();
+    active_handler.PostTask([] { std::cout << "stale steps have been skipped\n"; });
+}
+
+void TaskGraphDemo()
+{
+    ActiveThreadPool workers(4);
+    TaskGraph graph;
+    auto load = graph.AddNode([] { std::cout << "loading input\n"; });
+    auto parse = graph.AddNode([] { std::cout << "parsing input\n"; });
+    auto index = graph.AddNode([] { std::cout << "building index\n"; });
+    auto report = graph.AddNode([] { std::cout << "writing report\n"; });
+    graph.AddEdge(load, parse);
+    graph.AddEdge(load, index);
+    graph.AddEdge(parse, report);
+    graph.AddEdge(index, report);
+    for (int i = 0; i < 2; ++i) {
+        std::cout << "running the graph in the " << i << "th round\n";
+        graph.RunAndWait(&workers);
+    }
+
+    // The round lasts until its completion callback returns.
+    graph.Run(&workers, [&graph, &workers] {
+        try {
+            graph.Run(&workers, nullptr);
+        } catch (const std::logic_error&) {
+            std::cout << "no new round while the last one is finishing\n";
+        }
+    });
+    graph.Wait();
+}
+
+#if defined(__linux__)
+void IOActiveThreadDemo()
+{
+    int fds[2];
+    if (pipe(fds) == -1) {
+        return;
+    }
+
+    {
+        IOActiveThread io_handler;
+        auto watched = io_handler.WatchFileDescriptor(fds[0], EPOLLIN, [fd = fds[0]](uint32_t) {
+            char buf[64];
+            auto n = read(fd, buf, sizeof(buf));
+            std::cout << "io handler reads: " << std::string(buf, n > 0 ? n : 0) << "\n";
+        });
+        watched.get();
+
+        // A bad file descriptor is reported to the caller rather than killing the loop.
+        try {
+            io_handler.WatchFileDescriptor(-1, EPOLLIN, [](uint32_t) {}).get();
+        } catch (const std::system_error& ex) {
+            std::cout << "failed to watch: " << ex.what() << "\n";
+        }
+        for (int i = 0; i < 3; ++i) {
+            io_handler.PostTask([fd = fds[1], i] {
+                auto msg = "message " + std::to_string(i);
+                write(fd, msg.data(), msg.size());
+            });
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+
+        io_handler.StopWatchingFileDescriptor(fds[0]);
+    }
+
+    close(fds[0]);
+    close(fds[1]);
+}
+#endif
 
 int main()
 {
     ActiveThread active_handler;
     active_handler.PostTask([] { std::cout << "active handler starts running\n"; });
+    active_handler.PostIdleTask([](IdleDeadline deadline) {
+        int chunks = 0;
+        while (std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            ++chunks;
+        }
+        std::cout << "idle task done " << chunks << " chunks of housekeeping\n";
+    });
     for (int i = 0; i < 10; ++i) {
+        active_handler.PostTask(TaskPriority::BEST_EFFORT,
+                                [i] { std::cout << "flushing stats of the " << i << "th round\n"; });
         active_handler.PostTask([i] { std::cout << "issuing in the " << i << "th round\n"; });
+        active_handler.PostTask(TaskPriority::HIGH,
+                                [i] { std::cout << "responding in the " << i << "th round\n"; });
         std::this_thread::sleep_for(std::chrono::milliseconds(500));
     }
 
+    CancellationDemo();
+    TaskGraphDemo();
+
+#if defined(__linux__)
+    IOActiveThreadDemo();
+#endif
+
     return 0;
 }
@@ -0,0 +1,173 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#include "task_graph.h"
+
+#include <stdexcept>
+
+#include "active_thread_pool.h"
+
+namespace {
+
+constexpr TaskGraph::NodeId kNoNode = static_cast<TaskGraph::NodeId>(-1);
+
+}   // namespace
+
+TaskGraph::TaskGraph()
+    : prepared_(false), remaining_(0), running_(false), workers_(nullptr)
+{}
+
+void TaskGraph::EnsureModifiable() const
+{
+    if (running_.load(std::memory_order_acquire)) {
+        throw std::logic_error("TaskGraph can't be modified while running");
+    }
+}
+
+TaskGraph::NodeId TaskGraph::AddNode(Task task)
+{
+    EnsureModifiable();
+    nodes_.emplace_back(std::move(task));
+    prepared_ = false;
+    return nodes_.size() - 1;
+}
+
+void TaskGraph::AddEdge(NodeId from, NodeId to)
+{
+    EnsureModifiable();
+    if (from >= nodes_.size() || to >= nodes_.size()) {
+        throw std::out_of_range("TaskGraph node id is out of range");
+    }
+
+    nodes_[from].successors.push_back(to);
+    ++nodes_[to].predecessor_count;
+    prepared_ = false;
+}
+
+void TaskGraph::Prepare()
+{
+    if (prepared_) {
+        return;
+    }
+
+    // Kahn's algorithm: every node is visited if and only if the graph has no cycle.
+    std::vector<size_t> in_degrees(nodes_.size());
+    std::vector<NodeId> visiting;
+    roots_.clear();
+    for (NodeId id = 0; id < nodes_.size(); ++id) {
+        in_degrees[id] = nodes_[id].predecessor_count;
+        if (in_degrees[id] == 0) {
+            roots_.push_back(id);
+            visiting.push_back(id);
+        }
+    }
+
+    size_t visited = 0;
+    while (!visiting.empty()) {
+        auto id = visiting.back();
+        visiting.pop_back();
+        ++visited;
+        for (auto successor : nodes_[id].successors) {
+            if (--in_degrees[successor] == 0) {
+                visiting.push_back(successor);
+            }
+        }
+    }
+
+    if (visited != nodes_.size()) {
+        throw std::logic_error("TaskGraph has a cycle");
+    }
+
+    pending_counts_ = std::make_unique<std::atomic<size_t>[]>(nodes_.size());
+    prepared_ = true;
+}
+
+void TaskGraph::Run(ActiveThreadPool* workers, Task on_done)
+{
+    if (running_.exchange(true, std::memory_order_acquire)) {
+        throw std::logic_error("TaskGraph is already running");
+    }
+
+    try {
+        Prepare();
+    } catch (...) {
+        running_.store(false, std::memory_order_release);
+        throw;
+    }
+
+    if (nodes_.empty()) {
+        Finish(std::move(on_done));
+        return;
+    }
+
+    workers_ = workers;
+    on_done_ = std::move(on_done);
+    remaining_.store(nodes_.size(), std::memory_order_relaxed);
+    for (NodeId id = 0; id < nodes_.size(); ++id) {
+        pending_counts_[id].store(nodes_[id].predecessor_count, std::memory_order_relaxed);
+    }
+
+    // Posting to workers publishes the state above.
+    for (auto root : roots_) {
+        workers_->PostTask([this, root] { RunNode(root); });
+    }
+}
+
+void TaskGraph::RunAndWait(ActiveThreadPool* workers)
+{
+    Run(workers, nullptr);
+    Wait();
+}
+
+void TaskGraph::Wait()
+{
+    std::unique_lock<std::mutex> lock(finished_mutex_);
+    finished_cv_.wait(lock, [this] { return !running_.load(std::memory_order_acquire); });
+}
+
+void TaskGraph::RunNode(NodeId id)
+{
+    while (id != kNoNode) {
+        const auto& node = nodes_[id];
+        if (node.task) {
+            node.task();
+        }
+
+        NodeId next = kNoNode;
+        for (auto successor : node.successors) {
+            if (pending_counts_[successor].fetch_sub(1, std::memory_order_acq_rel) != 1) {
+                continue;
+            }
+
+            // Saves a hop through the task queue for the first runnable successor.
+            if (next == kNoNode) {
+                next = successor;
+            } else {
+                workers_->PostTask([this, successor] { RunNode(successor); });
+            }
+        }
+
+        if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            auto on_done = std::move(on_done_);
+            on_done_ = nullptr;
+            Finish(std::move(on_done));
+            return;
+        }
+
+        id = next;
+    }
+}
+
+void TaskGraph::Finish(Task on_done)
+{
+    if (on_done) {
+        on_done();
+    }
+
+    // Notifying under the lock keeps the graph alive until the waiter, which may destroy
+    // the graph as soon as it wakes up, can take the lock.
+    std::lock_guard<std::mutex> lock(finished_mutex_);
+    running_.store(false, std::memory_order_release);
+    finished_cv_.notify_all();
+}
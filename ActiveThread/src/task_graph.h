@@ -0,0 +1,99 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+#ifndef EUREKA_ACTIVE_THREAD_TASK_GRAPH_H_
+#define EUREKA_ACTIVE_THREAD_TASK_GRAPH_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "basic_macros.h"
+#include "task_queue.h"
+
+class ActiveThreadPool;
+
+// A DAG of tasks, which can be run on an ActiveThreadPool for many times.
+// A node becomes runnable once all its predecessors have finished; a finishing node runs
+// one of its newly runnable successors in place, and posts the others to the pool.
+// The graph must outlive every run, and it can't be modified or run again until the
+// current run finishes.
+class TaskGraph {
+public:
+    using NodeId = size_t;
+
+    TaskGraph();
+
+    ~TaskGraph() = default;
+
+    DISALLOW_COPY(TaskGraph);
+
+    DISALLOW_MOVE(TaskGraph);
+
+    NodeId AddNode(Task task);
+
+    // `to` runs after `from` has finished.
+    void AddEdge(NodeId from, NodeId to);
+
+    // Returns immediately; `on_done` is called on the worker that finishes the last node.
+    // The run lasts until `on_done` returns, thus calling Run() from within `on_done`, or
+    // before it returns, throws as well.
+    // Throws std::logic_error if the graph is running or has a cycle.
+    void Run(ActiveThreadPool* workers, Task on_done);
+
+    // Blocks the calling thread until the run finishes.
+    // Never call it on a worker of `workers`.
+    void RunAndWait(ActiveThreadPool* workers);
+
+    // Blocks the calling thread until the current run, if any, finishes.
+    // Never call it on a worker running the graph.
+    void Wait();
+
+    size_t size() const noexcept
+    {
+        return nodes_.size();
+    }
+
+private:
+    struct Node {
+        explicit Node(Task&& task)
+            : task(std::move(task)), predecessor_count(0)
+        {}
+
+        Task task;
+        std::vector<NodeId> successors;
+        size_t predecessor_count;
+    };
+
+    void EnsureModifiable() const;
+
+    // Checks acyclicity and collects root nodes, once after each modification.
+    void Prepare();
+
+    void RunNode(NodeId id);
+
+    // Calls `on_done`, and then ends the run.
+    void Finish(Task on_done);
+
+private:
+    std::vector<Node> nodes_;
+    std::vector<NodeId> roots_;
+    bool prepared_;
+    std::unique_ptr<std::atomic<size_t>[]> pending_counts_;
+    std::atomic<size_t> remaining_;
+    std::atomic<bool> running_;
+    ActiveThreadPool* workers_;
+    Task on_done_;
+    // Signals the end of a run, which is the last time the run touches the graph.
+    std::mutex finished_mutex_;
+    std::condition_variable finished_cv_;
+};
+
+#endif  // EUREKA_ACTIVE_THREAD_TASK_GRAPH_H_
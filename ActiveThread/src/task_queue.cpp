@@ -0,0 +1,81 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#include "task_queue.h"
+
+#include <algorithm>
+
+TaskQueue::TaskQueue(size_t starvation_limit, std::chrono::milliseconds idle_time_slice)
+    : starvation_limit_(starvation_limit), idle_time_slice_(idle_time_slice)
+{
+    streaks_.fill(0);
+}
+
+void TaskQueue::Push(TaskPriority priority, Task&& task, CancellationToken token)
+{
+    lanes_[static_cast<size_t>(priority)].emplace_back(std::move(task), std::move(token));
+}
+
+void TaskQueue::PushIdle(IdleTask&& task)
+{
+    idle_tasks_.push_back(std::move(task));
+}
+
+void TaskQueue::DropCancelledTasks()
+{
+    for (auto& tasks : lanes_) {
+        while (!tasks.empty() && tasks.front().token.IsCancelled()) {
+            tasks.pop_front();
+        }
+    }
+}
+
+bool TaskQueue::PopTask(Task* task)
+{
+    DropCancelledTasks();
+    for (size_t lane = 0; lane < kLaneCount; ++lane) {
+        auto& tasks = lanes_[lane];
+        if (tasks.empty()) {
+            continue;
+        }
+
+        bool lower_waiting = std::any_of(lanes_.cbegin() + lane + 1, lanes_.cend(),
+                                         [](const auto& lower) { return !lower.empty(); });
+        if (!lower_waiting) {
+            streaks_[lane] = 0;
+        } else if (starvation_limit_ != 0 && streaks_[lane] >= starvation_limit_) {
+            // Yield this turn to lower lanes.
+            streaks_[lane] = 0;
+            continue;
+        } else {
+            ++streaks_[lane];
+        }
+
+        *task = std::move(tasks.front().task);
+        tasks.pop_front();
+        return true;
+    }
+
+    return false;
+}
+
+bool TaskQueue::PopIdleTask(Task* task)
+{
+    if (HasPendingTasks() || idle_tasks_.empty()) {
+        return false;
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + idle_time_slice_;
+    auto idle_task = std::move(idle_tasks_.front());
+    idle_tasks_.pop_front();
+    *task = [idle_task = std::move(idle_task), deadline] { idle_task(deadline); };
+
+    return true;
+}
+
+bool TaskQueue::HasPendingTasks() const
+{
+    return std::any_of(lanes_.cbegin(), lanes_.cend(),
+                       [](const auto& tasks) { return !tasks.empty(); });
+}
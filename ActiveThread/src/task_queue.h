@@ -0,0 +1,95 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+#ifndef EUREKA_ACTIVE_THREAD_TASK_QUEUE_H_
+#define EUREKA_ACTIVE_THREAD_TASK_QUEUE_H_
+
+#include <array>
+#include <chrono>
+#include <deque>
+#include <functional>
+
+#include "basic_macros.h"
+#include "cancellation_token.h"
+
+using Task = std::function<void()>;
+
+using IdleDeadline = std::chrono::steady_clock::time_point;
+
+// An idle task should check the deadline regularly, and return as soon as it has passed, so
+// that tasks arriving in the meantime are not kept waiting.
+using IdleTask = std::function<void(IdleDeadline)>;
+
+enum class TaskPriority : int {
+    HIGH,
+    NORMAL,
+    BEST_EFFORT
+};
+
+// Keeps pending tasks in one lane per priority, plus idle tasks which are handed out only
+// when all lanes are empty.
+// The highest non-empty lane is served first; but once a lane has been served for
+// `starvation_limit` times in a row while a lower lane was waiting, the next turn goes to
+// the lower lane. A limit of 0 means strict priority.
+// Note that this class itself is not thread-safe, its owner should take care of that.
+class TaskQueue {
+public:
+    TaskQueue(size_t starvation_limit, std::chrono::milliseconds idle_time_slice);
+
+    ~TaskQueue() = default;
+
+    DISALLOW_COPY(TaskQueue);
+
+    DISALLOW_MOVE(TaskQueue);
+
+    void Push(TaskPriority priority, Task&& task, CancellationToken token = CancellationToken());
+
+    void PushIdle(IdleTask&& task);
+
+    // Returns false if all lanes are empty, or have only cancelled tasks left.
+    bool PopTask(Task* task);
+
+    // Returns false if any lane is non-empty or there is no idle task.
+    // Cancelled tasks still count until they are dropped by `PopTask()`.
+    // The idle task popped is bound with its deadline.
+    bool PopIdleTask(Task* task);
+
+    bool Pop(Task* task)
+    {
+        return PopTask(task) || PopIdleTask(task);
+    }
+
+    bool HasPendingTasks() const;
+
+    bool empty() const
+    {
+        return !HasPendingTasks() && idle_tasks_.empty();
+    }
+
+private:
+    struct PendingTask {
+        PendingTask(Task&& task, CancellationToken&& token)
+            : task(std::move(task)), token(std::move(token))
+        {}
+
+        Task task;
+        CancellationToken token;
+    };
+
+    void DropCancelledTasks();
+
+private:
+    static constexpr size_t kLaneCount = 3;
+    std::array<std::deque<PendingTask>, kLaneCount> lanes_;
+    std::array<size_t, kLaneCount> streaks_;
+    std::deque<IdleTask> idle_tasks_;
+    size_t starvation_limit_;
+    std::chrono::milliseconds idle_time_slice_;
+};
+
+#endif  // EUREKA_ACTIVE_THREAD_TASK_QUEUE_H_
@@ -0,0 +1,288 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+#ifndef EUREKA_BENCHMARK_HARNESS_H_
+#define EUREKA_BENCHMARK_HARNESS_H_
+
+// The scaffolding shared by benchmarks of the projects here, which keep only their scenarios:
+//   FlagParser:  parses flags of the form --name=value, and switches of the form --name.
+//   RunTogether: runs threads released all at once, for measuring contention.
+//   ResultLine:  prints a result as one line of text, or as one JSON object per line.
+// Header-only; a benchmark adds this directory to its include directories.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace bench {
+
+using Clock = std::chrono::steady_clock;
+
+inline uint64_t ElapsedNanoseconds(Clock::time_point from, Clock::time_point to)
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count());
+}
+
+inline double ElapsedSeconds(Clock::time_point from, Clock::time_point to)
+{
+    return std::chrono::duration<double>(to - from).count();
+}
+
+class FlagParser {
+public:
+    // A comma separated list of positive integers, e.g. --threads=2,8,32.
+    FlagParser& Counts(const char* name, std::vector<int>* counts)
+    {
+        return Add(name, "N,...", [counts](const char* value) {
+            std::vector<int> parsed;
+            for (char* end = nullptr; *value != '\0'; value = *end == ',' ? end + 1 : end) {
+                auto count = static_cast<int>(std::strtol(value, &end, 10));
+                if (end == value || count <= 0) {
+                    return false;
+                }
+
+                parsed.push_back(count);
+            }
+
+            *counts = std::move(parsed);
+            return !counts->empty();
+        });
+    }
+
+    // Values below `min_value` are raised to it.
+    template<typename Integer>
+    FlagParser& Number(const char* name, Integer* number,
+                       typename std::common_type<Integer>::type min_value = 0)
+    {
+        static_assert(std::is_integral<Integer>::value, "Integer must be integral");
+        return Add(name, "N", [number, min_value](const char* value) {
+            char* end = nullptr;
+            auto parsed = std::strtoll(value, &end, 10);
+            if (end == value || *end != '\0' || parsed < 0) {
+                return false;
+            }
+
+            *number = std::max(min_value, static_cast<Integer>(parsed));
+            return true;
+        });
+    }
+
+    FlagParser& String(const char* name, std::string* str, const char* placeholder = "VALUE")
+    {
+        return Add(name, placeholder, [str](const char* value) {
+            *str = value;
+            return true;
+        });
+    }
+
+    FlagParser& Switch(const char* name, bool* on)
+    {
+        flags_.push_back(Flag{name, std::string(), [on](const char*) {
+            *on = true;
+            return true;
+        }});
+        return *this;
+    }
+
+    // Returns false on unknown or malformed flags.
+    bool Parse(int argc, char* argv[]) const
+    {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg(argv[i]);
+            auto flag = std::find_if(flags_.cbegin(), flags_.cend(), [&arg](const Flag& flag) {
+                if (flag.placeholder.empty()) {
+                    return arg == flag.name;
+                }
+
+                return arg.compare(0, flag.name.size(), flag.name) == 0 &&
+                       arg.size() > flag.name.size() && arg[flag.name.size()] == '=';
+            });
+            if (flag == flags_.cend()) {
+                return false;
+            }
+
+            auto value = flag->placeholder.empty() ? "" : arg.c_str() + flag->name.size() + 1;
+            if (!flag->set(value)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // E.g. "[--threads=N,...] [--json]".
+    std::string Usage() const
+    {
+        std::string usage;
+        for (const auto& flag : flags_) {
+            usage += usage.empty() ? "[" : " [";
+            usage += flag.name;
+            if (!flag.placeholder.empty()) {
+                usage += "=" + flag.placeholder;
+            }
+
+            usage += "]";
+        }
+
+        return usage;
+    }
+
+    void PrintUsage(const char* program) const
+    {
+        fprintf(stderr, "usage: %s %s\n", program, Usage().c_str());
+    }
+
+private:
+    // A switch has no placeholder.
+    struct Flag {
+        std::string name;
+        std::string placeholder;
+        std::function<bool(const char*)> set;
+    };
+
+    FlagParser& Add(const char* name, const char* placeholder,
+                    std::function<bool(const char*)> set)
+    {
+        flags_.push_back(Flag{name, placeholder, std::move(set)});
+        return *this;
+    }
+
+private:
+    std::vector<Flag> flags_;
+};
+
+// Runs `body(id)` on `threads` threads, with ids in [0, threads), and releases them all at
+// once after every one has started; returns the moment of the release, after all threads
+// have finished.
+template<typename Body>
+Clock::time_point RunTogether(int threads, Body body)
+{
+    std::atomic<int> ready(0);
+    std::atomic<bool> start(false);
+    std::vector<std::thread> workers;
+    for (int id = 0; id < threads; ++id) {
+        workers.emplace_back([&, id] {
+            ready.fetch_add(1);
+            while (!start.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+
+            body(id);
+        });
+    }
+
+    while (ready.load() != threads) {
+        std::this_thread::yield();
+    }
+
+    auto started_at = Clock::now();
+    start.store(true, std::memory_order_release);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    return started_at;
+}
+
+// Runs `op()` for `iterations` times on each of `threads` threads released all at once;
+// returns the operations completed per second, over all threads.
+template<typename Op>
+double MeasureOps(int threads, int iterations, Op op)
+{
+    auto started_at = RunTogether(threads, [&](int) {
+        for (int i = 0; i < iterations; ++i) {
+            op();
+        }
+    });
+
+    return static_cast<double>(threads) * iterations / ElapsedSeconds(started_at, Clock::now());
+}
+
+// Collects the fields of a result, and prints them either as text, e.g.
+//   semaphore threads=8 ops_per_sec=1234.5
+// or as a JSON object, e.g.
+//   {"benchmark":"semaphore","threads":8,"ops_per_sec":1234.5}
+class ResultLine {
+public:
+    ResultLine(bool json, const char* benchmark)
+        : json_(json)
+    {
+        if (json_) {
+            line_ = "{\"benchmark\":\"" + std::string(benchmark) + "\"";
+        } else {
+            line_ = benchmark;
+        }
+    }
+
+    template<typename Integer>
+    typename std::enable_if<std::is_integral<Integer>::value, ResultLine&>::type
+    Add(const char* key, Integer value)
+    {
+        return AddField(key, std::is_signed<Integer>::value ?
+                                 std::to_string(static_cast<long long>(value)) :
+                                 std::to_string(static_cast<unsigned long long>(value)));
+    }
+
+    ResultLine& Add(const char* key, double value, int precision = 1)
+    {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%.*f", precision, value);
+        return AddField(key, buf);
+    }
+
+    ResultLine& Add(const char* key, bool value)
+    {
+        return AddField(key, value ? "true" : "false");
+    }
+
+    ResultLine& Add(const char* key, const char* value)
+    {
+        return AddField(key, json_ ? "\"" + std::string(value) + "\"" : std::string(value));
+    }
+
+    ResultLine& Add(const char* key, const std::string& value)
+    {
+        return Add(key, value.c_str());
+    }
+
+    // Prints the line, and flushes it at once, so that partial results survive a crash.
+    void Print() const
+    {
+        printf("%s%s\n", line_.c_str(), json_ ? "}" : "");
+        fflush(stdout);
+    }
+
+private:
+    ResultLine& AddField(const char* key, const std::string& value)
+    {
+        if (json_) {
+            line_ += ",\"" + std::string(key) + "\":" + value;
+        } else {
+            line_ += " " + std::string(key) + "=" + value;
+        }
+
+        return *this;
+    }
+
+private:
+    bool json_;
+    std::string line_;
+};
+
+}   // namespace bench
+
+#endif  // EUREKA_BENCHMARK_HARNESS_H_
@@ -0,0 +1,99 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+// Measures the cost of one barrier round, with all threads arriving at once, for:
+//   latch:          a fresh CountDownLatch per round, as the one-shot pattern has to do.
+//   cyclic_barrier: a single CyclicBarrier, where every party hits the same counter.
+//   tree_barrier:   a TreeBarrier, where parties only contend within their own node.
+// Usage:
+//   barrier-benchmark [--threads=8,32,128] [--rounds=N] [--fan-in=N] [--json]
+
+#include <memory>
+#include <vector>
+
+#include "benchmark_harness.h"
+
+#include "count_down_latch.h"
+#include "cyclic_barrier.h"
+#include "tree_barrier.h"
+
+namespace {
+
+struct Options {
+    std::vector<int> thread_counts {8, 32, 128};
+    int rounds = 2000;
+    int fan_in = 4;
+    bool json = false;
+};
+
+// Runs `arrive(id, round)` for every round on `threads` threads, all released at once;
+// returns the average cost of a round in nanoseconds.
+template<typename Arrive>
+double MeasureRounds(int threads, int rounds, Arrive arrive)
+{
+    auto started_at = bench::RunTogether(threads, [&](int id) {
+        for (int round = 0; round < rounds; ++round) {
+            arrive(id, round);
+        }
+    });
+
+    return static_cast<double>(bench::ElapsedNanoseconds(started_at, bench::Clock::now())) /
+           rounds;
+}
+
+void Report(const Options& options, const char* name, int threads, double ns_per_round)
+{
+    bench::ResultLine(options.json, name)
+        .Add("threads", threads)
+        .Add("rounds", options.rounds)
+        .Add("fan_in", options.fan_in)
+        .Add("ns_per_round", ns_per_round)
+        .Print();
+}
+
+void RunAll(const Options& options)
+{
+    for (auto threads : options.thread_counts) {
+        std::vector<std::unique_ptr<CountDownLatch>> latches;
+        for (int round = 0; round < options.rounds; ++round) {
+            latches.push_back(std::make_unique<CountDownLatch>(threads));
+        }
+
+        Report(options, "latch", threads,
+               MeasureRounds(threads, options.rounds, [&latches](int, int round) {
+                   latches[round]->ArriveAndWait();
+               }));
+
+        CyclicBarrier cyclic_barrier(threads);
+        Report(options, "cyclic_barrier", threads,
+               MeasureRounds(threads, options.rounds, [&cyclic_barrier](int, int) {
+                   cyclic_barrier.ArriveAndWait();
+               }));
+
+        TreeBarrier tree_barrier(threads, options.fan_in);
+        Report(options, "tree_barrier", threads,
+               MeasureRounds(threads, options.rounds, [&tree_barrier](int id, int) {
+                   tree_barrier.ArriveAndWait(id);
+               }));
+    }
+}
+
+}   // namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    bench::FlagParser flags;
+    flags.Counts("--threads", &options.thread_counts)
+         .Number("--rounds", &options.rounds, 1)
+         .Number("--fan-in", &options.fan_in, 2)
+         .Switch("--json", &options.json);
+    if (!flags.Parse(argc, argv)) {
+        flags.PrintUsage(argv[0]);
+        return 1;
+    }
+
+    RunAll(options);
+    return 0;
+}
@@ -0,0 +1,247 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+// Measures handing items over through a bounded queue, with N producers and N consumers
+// that block whenever the queue is full or empty, for:
+//   event_count: a lock-free ring buffer, made blocking with two EventCounts.
+//   condvar:     a std::deque guarded by a mutex, with two condition variables.
+// Usage:
+//   event-count-benchmark [--pairs=1,4,16] [--capacity=N] [--items=N] [--json]
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "benchmark_harness.h"
+
+#include "compiler_helper.h"
+#include "event_count.h"
+
+namespace {
+
+struct Options {
+    std::vector<int> pair_counts {1, 4, 16};
+    size_t capacity = 1024;
+    int items = 1000000;
+    bool json = false;
+};
+
+// A bounded multi-producer multi-consumer ring buffer, where every slot carries a sequence
+// number telling whose turn it is; `capacity` must be a power of 2.
+class RingBuffer {
+public:
+    explicit RingBuffer(size_t capacity)
+        : slots_(std::make_unique<Slot[]>(capacity)), mask_(capacity - 1),
+          enqueue_pos_(0), dequeue_pos_(0)
+    {
+        for (size_t i = 0; i < capacity; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool TryPush(int value)
+    {
+        auto pos = enqueue_pos_.load(std::memory_order_relaxed);
+        while (true) {
+            auto& slot = slots_[pos & mask_];
+            auto diff = static_cast<ptrdiff_t>(slot.sequence.load(std::memory_order_acquire) - pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.value = value;
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool TryPop(int* value)
+    {
+        auto pos = dequeue_pos_.load(std::memory_order_relaxed);
+        while (true) {
+            auto& slot = slots_[pos & mask_];
+            auto diff = static_cast<ptrdiff_t>(slot.sequence.load(std::memory_order_acquire) -
+                                               (pos + 1));
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    *value = slot.value;
+                    slot.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        int value;
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+    alignas(kCacheLineSize) std::atomic<size_t> enqueue_pos_;
+    alignas(kCacheLineSize) std::atomic<size_t> dequeue_pos_;
+};
+
+class EventCountQueue {
+public:
+    explicit EventCountQueue(size_t capacity)
+        : ring_(capacity)
+    {}
+
+    void Push(int value)
+    {
+        while (!ring_.TryPush(value)) {
+            auto key = not_full_.PrepareWait();
+            if (ring_.TryPush(value)) {
+                not_full_.CancelWait();
+                break;
+            }
+
+            not_full_.CommitWait(key);
+        }
+
+        not_empty_.Notify();
+    }
+
+    int Pop()
+    {
+        int value;
+        while (!ring_.TryPop(&value)) {
+            auto key = not_empty_.PrepareWait();
+            if (ring_.TryPop(&value)) {
+                not_empty_.CancelWait();
+                break;
+            }
+
+            not_empty_.CommitWait(key);
+        }
+
+        not_full_.Notify();
+        return value;
+    }
+
+private:
+    RingBuffer ring_;
+    EventCount not_empty_;
+    EventCount not_full_;
+};
+
+class CondVarQueue {
+public:
+    explicit CondVarQueue(size_t capacity)
+        : capacity_(capacity)
+    {}
+
+    void Push(int value)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_full_.wait(lock, [this] { return items_.size() < capacity_; });
+            items_.push_back(value);
+        }
+
+        not_empty_.notify_one();
+    }
+
+    int Pop()
+    {
+        int value;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_empty_.wait(lock, [this] { return !items_.empty(); });
+            value = items_.front();
+            items_.pop_front();
+        }
+
+        not_full_.notify_one();
+        return value;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::deque<int> items_;
+    size_t capacity_;
+};
+
+// Returns items handed over per second.
+template<typename Queue>
+double MeasureHandoff(int pairs, int items, size_t capacity)
+{
+    Queue queue(capacity);
+    auto items_per_pair = std::max(1, items / pairs);
+    auto started_at = bench::RunTogether(pairs * 2, [&](int id) {
+        for (int n = 0; n < items_per_pair; ++n) {
+            if (id % 2 == 0) {
+                queue.Push(n);
+            } else {
+                queue.Pop();
+            }
+        }
+    });
+
+    return static_cast<double>(items_per_pair) * pairs /
+           bench::ElapsedSeconds(started_at, bench::Clock::now());
+}
+
+void Report(const Options& options, const char* name, int pairs, double items_per_second)
+{
+    bench::ResultLine(options.json, name)
+        .Add("pairs", pairs)
+        .Add("capacity", options.capacity)
+        .Add("items", options.items)
+        .Add("items_per_sec", items_per_second)
+        .Print();
+}
+
+void RunAll(const Options& options)
+{
+    for (auto pairs : options.pair_counts) {
+        Report(options, "event_count", pairs,
+               MeasureHandoff<EventCountQueue>(pairs, options.items, options.capacity));
+        Report(options, "condvar", pairs,
+               MeasureHandoff<CondVarQueue>(pairs, options.items, options.capacity));
+    }
+}
+
+}   // namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    bench::FlagParser flags;
+    flags.Counts("--pairs", &options.pair_counts)
+         .Number("--capacity", &options.capacity, 2)
+         .Number("--items", &options.items, 1)
+         .Switch("--json", &options.json);
+    if (!flags.Parse(argc, argv)) {
+        flags.PrintUsage(argv[0]);
+        return 1;
+    }
+
+    // The ring buffer wants a power of 2.
+    size_t capacity = 2;
+    while (capacity < options.capacity) {
+        capacity *= 2;
+    }
+
+    options.capacity = capacity;
+    RunAll(options);
+    return 0;
+}
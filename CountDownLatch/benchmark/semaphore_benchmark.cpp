@@ -0,0 +1,121 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+// Measures a contended counting semaphore, where every thread repeatedly acquires a permit,
+// does a little work, and releases it, for:
+//   semaphore: the Semaphore, which parks on its permit counter only when it runs out.
+//   condvar:   a classic semaphore built on a mutex and a condition variable.
+// Usage:
+//   semaphore-benchmark [--threads=2,8,32] [--permits=N] [--iterations=N] [--json]
+// Without --permits, every run uses half as many permits as threads.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "benchmark_harness.h"
+
+#include "semaphore.h"
+
+namespace {
+
+struct Options {
+    std::vector<int> thread_counts {2, 8, 32};
+    int permits = 0;
+    int iterations = 100000;
+    bool json = false;
+};
+
+class CondVarSemaphore {
+public:
+    explicit CondVarSemaphore(int permits)
+        : permits_(permits)
+    {}
+
+    void Acquire()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return permits_ > 0; });
+        --permits_;
+    }
+
+    void Release()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++permits_;
+        }
+
+        cv_.notify_one();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    int permits_;
+};
+
+// Keeps a permit held for a short while, so that other threads really do run out of them.
+void DoWork()
+{
+    static std::atomic<int> sink(0);
+    for (int i = 0; i < 32; ++i) {
+        sink.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Report(const Options& options, const char* name, int threads, int permits,
+            double ops_per_second)
+{
+    bench::ResultLine(options.json, name)
+        .Add("threads", threads)
+        .Add("permits", permits)
+        .Add("iterations", options.iterations)
+        .Add("ops_per_sec", ops_per_second)
+        .Print();
+}
+
+void RunAll(const Options& options)
+{
+    for (auto threads : options.thread_counts) {
+        auto permits = options.permits > 0 ? options.permits : std::max(1, threads / 2);
+
+        Semaphore semaphore(permits);
+        Report(options, "semaphore", threads, permits,
+               bench::MeasureOps(threads, options.iterations, [&semaphore] {
+                   semaphore.Acquire();
+                   DoWork();
+                   semaphore.Release();
+               }));
+
+        CondVarSemaphore condvar_semaphore(permits);
+        Report(options, "condvar", threads, permits,
+               bench::MeasureOps(threads, options.iterations, [&condvar_semaphore] {
+                   condvar_semaphore.Acquire();
+                   DoWork();
+                   condvar_semaphore.Release();
+               }));
+    }
+}
+
+}   // namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    bench::FlagParser flags;
+    flags.Counts("--threads", &options.thread_counts)
+         .Number("--permits", &options.permits, 1)
+         .Number("--iterations", &options.iterations, 1)
+         .Switch("--json", &options.json);
+    if (!flags.Parse(argc, argv)) {
+        flags.PrintUsage(argv[0]);
+        return 1;
+    }
+
+    RunAll(options);
+    return 0;
+}
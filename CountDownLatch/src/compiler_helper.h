@@ -9,6 +9,8 @@
 #ifndef COMPILER_HELPER_H_
 #define COMPILER_HELPER_H_
 
+#include <cstddef>
+
 #define DISALLOW_COPY(CLASS)                    \
     CLASS(const CLASS&) = delete;               \
     CLASS& operator=(const CLASS&) = delete
@@ -17,4 +19,7 @@
     CLASS(CLASS&&) = delete;                    \
     CLASS& operator=(CLASS&&) = delete
 
+// Data written by different threads should be kept this far apart to avoid false sharing.
+constexpr size_t kCacheLineSize = 64;
+
 #endif  // COMPILER_HELPER_H_
\ No newline at end of file
@@ -5,30 +5,125 @@
 #include "count_down_latch.h"
 
 #include <cassert>
+#include <cstdint>
+#include <thread>
+
+#include "futex.h"
+
+CountDownLatch::Continuation* const CountDownLatch::kDetached =
+    reinterpret_cast<CountDownLatch::Continuation*>(static_cast<uintptr_t>(1));
 
 CountDownLatch::CountDownLatch(int count)
+    : count_(count), continuations_(count == 0 ? kDetached : nullptr)
 {
     assert(count >= 0);
-    count_ = count;
 }
 
-void CountDownLatch::Wait()
+CountDownLatch::~CountDownLatch()
+{
+    auto* continuation = continuations_.load(std::memory_order_acquire);
+    while (continuation != nullptr && continuation != kDetached) {
+        auto* next = continuation->next;
+        delete continuation;
+        continuation = next;
+    }
+}
+
+void CountDownLatch::Wait() const
 {
-    std::unique_lock<std::mutex> lock(mutex_);
-    latch_.wait(lock, [this] { return count_ <= 0; });
+    int count;
+    while ((count = count_.load(std::memory_order_acquire)) > 0) {
+        FutexWait(&count_, count);
+    }
+
+    WaitForContinuationsDetached();
+}
+
+bool CountDownLatch::WaitUntil(std::chrono::steady_clock::time_point deadline) const
+{
+    int count;
+    while ((count = count_.load(std::memory_order_acquire)) > 0) {
+        auto timeout = deadline - std::chrono::steady_clock::now();
+        if (timeout <= timeout.zero()) {
+            return false;
+        }
+
+        FutexWaitFor(&count_, count, timeout);
+    }
+
+    WaitForContinuationsDetached();
+    return true;
+}
+
+void CountDownLatch::WaitForContinuationsDetached() const
+{
+    // The last arrival detaches right after bringing the count to zero.
+    while (continuations_.load(std::memory_order_acquire) != kDetached) {
+        std::this_thread::yield();
+    }
 }
 
 void CountDownLatch::Countdown()
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    --count_;
-    if (count_ == 0) {
-        latch_.notify_all();
+    Countdown(1);
+}
+
+void CountDownLatch::Countdown(int n)
+{
+    assert(n > 0);
+    auto prev = count_.fetch_sub(n, std::memory_order_acq_rel);
+    if (prev > 0 && prev <= n) {
+        RunContinuations();
+        // Waking up when there is no waiter is rare enough, since it happens only once.
+        FutexWakeAll(&count_);
     }
 }
 
+void CountDownLatch::ArriveAndWait(int n)
+{
+    Countdown(n);
+    Wait();
+}
+
 int CountDownLatch::count() const
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return count_;
-}
\ No newline at end of file
+    return count_.load(std::memory_order_relaxed);
+}
+
+void CountDownLatch::AddContinuation(std::function<void()> continuation)
+{
+    auto* node = new Continuation {std::move(continuation), nullptr};
+    auto* head = continuations_.load(std::memory_order_acquire);
+    while (head != kDetached) {
+        node->next = head;
+        if (continuations_.compare_exchange_weak(head, node, std::memory_order_acq_rel,
+                                                 std::memory_order_acquire)) {
+            return;
+        }
+    }
+
+    // The count has reached zero.
+    node->fn();
+    delete node;
+}
+
+void CountDownLatch::RunContinuations()
+{
+    auto* continuation = continuations_.exchange(kDetached, std::memory_order_acq_rel);
+
+    // Continuations were pushed in LIFO order.
+    Continuation* reversed = nullptr;
+    while (continuation != nullptr) {
+        auto* next = continuation->next;
+        continuation->next = reversed;
+        reversed = continuation;
+        continuation = next;
+    }
+
+    while (reversed != nullptr) {
+        auto* next = reversed->next;
+        reversed->fn();
+        delete reversed;
+        reversed = next;
+    }
+}
@@ -9,31 +9,120 @@
 #ifndef EUREKA_COUNT_DOWN_LATCH_H_
 #define EUREKA_COUNT_DOWN_LATCH_H_
 
-#include <condition_variable>
-#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#endif
 
 #include "compiler_helper.h"
 
+// Arrivals are a single atomic subtraction; only the arrival that brings the count to zero
+// wakes waiters, and waiters park on the counter itself only if it is still non-zero.
+// Instead of blocking, a join point can also register continuations, which are posted to
+// their executors by the arrival that brings the count to zero.
 class CountDownLatch {
 public:
     explicit CountDownLatch(int count);
 
-    ~CountDownLatch() = default;
+    // Continuations still pending are discarded.
+    ~CountDownLatch();
 
     DISALLOW_COPY(CountDownLatch);
 
     DISALLOW_MOVE(CountDownLatch);
 
-    void Wait();
+    void Wait() const;
+
+    // Returns false if the count didn't reach zero within `timeout`.
+    template<typename Rep, typename Period>
+    bool WaitFor(const std::chrono::duration<Rep, Period>& timeout) const
+    {
+        return WaitUntil(std::chrono::steady_clock::now() +
+                         std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+    }
+
+    bool WaitUntil(std::chrono::steady_clock::time_point deadline) const;
+
+    // Posts `callback` to `executor` once the count reaches zero, or right away if it has.
+    // `executor` can be anything providing PostTask(std::function<void()>&&), e.g.
+    // an ActiveThread, and it must outlive the latch's reaching zero.
+    template<typename Executor>
+    void OnZero(std::function<void()> callback, Executor& executor)
+    {
+        AddContinuation([&executor, callback = std::move(callback)]() mutable {
+            executor.PostTask(std::move(callback));
+        });
+    }
+
+#if defined(__cpp_impl_coroutine)
+    template<typename Executor>
+    class ZeroAwaiter {
+    public:
+        ZeroAwaiter(CountDownLatch& latch, Executor& executor)
+            : latch_(latch), executor_(executor)
+        {}
+
+        bool await_ready() const noexcept
+        {
+            return latch_.count() <= 0;
+        }
+
+        void await_suspend(std::coroutine_handle<> coroutine)
+        {
+            latch_.OnZero([coroutine] { coroutine.resume(); }, executor_);
+        }
+
+        void await_resume() const noexcept
+        {}
+
+    private:
+        CountDownLatch& latch_;
+        Executor& executor_;
+    };
+
+    // `co_await latch.WaitAsync(executor)` resumes the coroutine on `executor` once the count
+    // reaches zero.
+    template<typename Executor>
+    ZeroAwaiter<Executor> WaitAsync(Executor& executor)
+    {
+        return ZeroAwaiter<Executor>(*this, executor);
+    }
+#endif
 
     void Countdown();
 
+    void Countdown(int n);
+
+    void ArriveAndWait(int n = 1);
+
     int count() const;
 
 private:
-    int count_;
-    mutable std::mutex mutex_;
-    std::condition_variable latch_;
+    struct Continuation {
+        std::function<void()> fn;
+        Continuation* next;
+    };
+
+    // Marks the continuation list once it has been detached; no more continuation can be
+    // added from then on.
+    static Continuation* const kDetached;
+
+    void AddContinuation(std::function<void()> continuation);
+
+    // Detaches all continuations from the latch before running them, so that the latch can
+    // be destroyed while they are running.
+    void RunContinuations();
+
+    // Waiters may destroy the latch as soon as they return, thus they have to wait for
+    // continuations to be detached from the latch.
+    void WaitForContinuationsDetached() const;
+
+private:
+    std::atomic<int> count_;
+    std::atomic<Continuation*> continuations_;
 };
 
 #endif
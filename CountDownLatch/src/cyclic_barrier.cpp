@@ -0,0 +1,38 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#include "cyclic_barrier.h"
+
+#include <cassert>
+
+#include "futex.h"
+
+CyclicBarrier::CyclicBarrier(int parties, std::function<void()> completion)
+    : parties_(parties), completion_(std::move(completion)), arrived_(0), generation_(0)
+{
+    assert(parties > 0);
+}
+
+bool CyclicBarrier::ArriveAndWait()
+{
+    // No one can start the next round before the generation flips, thus the generation read
+    // here is the one of the round we are arriving at.
+    auto generation = generation_.load(std::memory_order_acquire);
+    if (arrived_.fetch_add(1, std::memory_order_acq_rel) + 1 == parties_) {
+        arrived_.store(0, std::memory_order_relaxed);
+        if (completion_) {
+            completion_();
+        }
+
+        generation_.store(generation + 1, std::memory_order_release);
+        FutexWakeAll(&generation_);
+        return true;
+    }
+
+    while (generation_.load(std::memory_order_acquire) == generation) {
+        FutexWait(&generation_, generation);
+    }
+
+    return false;
+}
@@ -0,0 +1,45 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+#ifndef EUREKA_CYCLIC_BARRIER_H_
+#define EUREKA_CYCLIC_BARRIER_H_
+
+#include <atomic>
+#include <functional>
+
+#include "compiler_helper.h"
+
+// A reusable barrier for a fixed number of parties.
+// The last arriver of a round runs the completion, then flips the generation, which is the
+// word all waiters park on; thus a round costs no allocation and only one wakeup broadcast.
+class CyclicBarrier {
+public:
+    explicit CyclicBarrier(int parties, std::function<void()> completion = nullptr);
+
+    ~CyclicBarrier() = default;
+
+    DISALLOW_COPY(CyclicBarrier);
+
+    DISALLOW_MOVE(CyclicBarrier);
+
+    // Returns true for the last arriver of the round.
+    bool ArriveAndWait();
+
+    int parties() const noexcept
+    {
+        return parties_;
+    }
+
+private:
+    const int parties_;
+    std::function<void()> completion_;
+    std::atomic<int> arrived_;
+    std::atomic<int> generation_;
+};
+
+#endif  // EUREKA_CYCLIC_BARRIER_H_
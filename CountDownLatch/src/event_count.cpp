@@ -0,0 +1,62 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#include "event_count.h"
+
+#include <cassert>
+
+#include "futex.h"
+
+EventCount::EventCount()
+    : epoch_(0), waiters_(0)
+{}
+
+EventCount::Key EventCount::PrepareWait()
+{
+    // Pairs with the fence in DoNotify(): either the producer sees us waiting, or we see the
+    // condition it has made true when checking again.
+    waiters_.fetch_add(1, std::memory_order_seq_cst);
+    return epoch_.load(std::memory_order_acquire);
+}
+
+void EventCount::CancelWait()
+{
+    auto prev = waiters_.fetch_sub(1, std::memory_order_relaxed);
+    assert(prev > 0);
+    (void)prev;
+}
+
+void EventCount::CommitWait(Key key)
+{
+    while (epoch_.load(std::memory_order_acquire) == key) {
+        FutexWait(&epoch_, key);
+    }
+
+    CancelWait();
+}
+
+void EventCount::Notify()
+{
+    DoNotify(false);
+}
+
+void EventCount::NotifyAll()
+{
+    DoNotify(true);
+}
+
+void EventCount::DoNotify(bool all)
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters_.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+
+    epoch_.fetch_add(1, std::memory_order_release);
+    if (all) {
+        FutexWakeAll(&epoch_);
+    } else {
+        FutexWakeOne(&epoch_);
+    }
+}
@@ -0,0 +1,57 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+#ifndef EUREKA_EVENT_COUNT_H_
+#define EUREKA_EVENT_COUNT_H_
+
+#include <atomic>
+
+#include "compiler_helper.h"
+
+// Adds blocking to lock-free data structures without a mutex.
+// A consumer that found nothing to take does:
+//     auto key = event_count.PrepareWait();
+//     if (check the condition again succeeds) {
+//         event_count.CancelWait();
+//     } else {
+//         event_count.CommitWait(key);
+//     }
+// and a producer calls Notify() or NotifyAll() after making the condition true.
+// Notifying is only a fence and a load when nobody is waiting.
+class EventCount {
+public:
+    using Key = int;
+
+    EventCount();
+
+    ~EventCount() = default;
+
+    DISALLOW_COPY(EventCount);
+
+    DISALLOW_MOVE(EventCount);
+
+    Key PrepareWait();
+
+    void CancelWait();
+
+    // Blocks until any notification since the PrepareWait() that returned `key`.
+    void CommitWait(Key key);
+
+    void Notify();
+
+    void NotifyAll();
+
+private:
+    void DoNotify(bool all);
+
+private:
+    std::atomic<int> epoch_;
+    std::atomic<int> waiters_;
+};
+
+#endif  // EUREKA_EVENT_COUNT_H_
@@ -0,0 +1,154 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#include "futex.h"
+
+#if defined(_WIN32)
+#include <Windows.h>
+#pragma comment(lib, "Synchronization.lib")
+#elif defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <climits>
+#include <ctime>
+#else
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#endif
+
+static_assert(sizeof(std::atomic<int>) == sizeof(int), "futex requires a plain 32-bit word");
+
+#if defined(_WIN32)
+
+void FutexWait(const std::atomic<int>* address, int expected)
+{
+    WaitOnAddress(const_cast<std::atomic<int>*>(address), &expected, sizeof(int), INFINITE);
+}
+
+bool FutexWaitFor(const std::atomic<int>* address, int expected,
+                  std::chrono::nanoseconds timeout)
+{
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(timeout).count();
+    auto wait_ms = static_cast<DWORD>(ms < 0 ? 0 : (ms >= INFINITE ? INFINITE - 1 : ms));
+    if (WaitOnAddress(const_cast<std::atomic<int>*>(address), &expected, sizeof(int), wait_ms)) {
+        return true;
+    }
+
+    return GetLastError() != ERROR_TIMEOUT;
+}
+
+void FutexWakeOne(const std::atomic<int>* address)
+{
+    WakeByAddressSingle(const_cast<std::atomic<int>*>(address));
+}
+
+void FutexWakeAll(const std::atomic<int>* address)
+{
+    WakeByAddressAll(const_cast<std::atomic<int>*>(address));
+}
+
+#elif defined(__linux__)
+
+namespace {
+
+long Futex(const std::atomic<int>* address, int op, int value, const timespec* timeout)
+{
+    return syscall(SYS_futex, reinterpret_cast<const int*>(address), op, value, timeout,
+                   nullptr, 0);
+}
+
+}   // namespace
+
+void FutexWait(const std::atomic<int>* address, int expected)
+{
+    Futex(address, FUTEX_WAIT_PRIVATE, expected, nullptr);
+}
+
+bool FutexWaitFor(const std::atomic<int>* address, int expected,
+                  std::chrono::nanoseconds timeout)
+{
+    if (timeout.count() <= 0) {
+        return false;
+    }
+
+    timespec ts;
+    ts.tv_sec = static_cast<time_t>(timeout.count() / 1000000000);
+    ts.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+    if (Futex(address, FUTEX_WAIT_PRIVATE, expected, &ts) == -1) {
+        return errno != ETIMEDOUT;
+    }
+
+    return true;
+}
+
+void FutexWakeOne(const std::atomic<int>* address)
+{
+    Futex(address, FUTEX_WAKE_PRIVATE, 1, nullptr);
+}
+
+void FutexWakeAll(const std::atomic<int>* address)
+{
+    Futex(address, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr);
+}
+
+#else
+
+namespace {
+
+// Waiters check the value under the bucket lock, and wakers take the same lock after
+// changing the value, therefore no wakeup is lost.
+struct Bucket {
+    std::mutex mutex;
+    std::condition_variable cv;
+};
+
+Bucket& BucketFor(const std::atomic<int>* address)
+{
+    constexpr size_t kBucketCount = 64;
+    static Bucket buckets[kBucketCount];
+    auto hash = reinterpret_cast<uintptr_t>(address) / sizeof(int);
+    return buckets[hash % kBucketCount];
+}
+
+}   // namespace
+
+void FutexWait(const std::atomic<int>* address, int expected)
+{
+    auto& bucket = BucketFor(address);
+    std::unique_lock<std::mutex> lock(bucket.mutex);
+    if (address->load() == expected) {
+        bucket.cv.wait(lock);
+    }
+}
+
+bool FutexWaitFor(const std::atomic<int>* address, int expected,
+                  std::chrono::nanoseconds timeout)
+{
+    auto& bucket = BucketFor(address);
+    std::unique_lock<std::mutex> lock(bucket.mutex);
+    if (address->load() != expected) {
+        return true;
+    }
+
+    return bucket.cv.wait_for(lock, timeout) == std::cv_status::no_timeout;
+}
+
+void FutexWakeOne(const std::atomic<int>* address)
+{
+    // Other addresses may share the bucket, thus waking only one may pick a wrong waiter.
+    FutexWakeAll(address);
+}
+
+void FutexWakeAll(const std::atomic<int>* address)
+{
+    auto& bucket = BucketFor(address);
+    std::lock_guard<std::mutex> lock(bucket.mutex);
+    bucket.cv.notify_all();
+}
+
+#endif
@@ -0,0 +1,32 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+#ifndef EUREKA_FUTEX_H_
+#define EUREKA_FUTEX_H_
+
+#include <atomic>
+#include <chrono>
+
+// Thin wrappers over the platform's wait-on-address facility: futex on Linux, and
+// WaitOnAddress on Windows; other platforms fall back to hashed mutex-condvar buckets.
+// As with the underlying facilities, waiters may wake up spuriously, thus they should always
+// recheck the value in a loop.
+
+// Blocks only if `*address == expected`.
+void FutexWait(const std::atomic<int>* address, int expected);
+
+// Returns false if it timed out.
+bool FutexWaitFor(const std::atomic<int>* address, int expected,
+                  std::chrono::nanoseconds timeout);
+
+// It is fine to wake on an address whose object has been destroyed.
+void FutexWakeOne(const std::atomic<int>* address);
+
+void FutexWakeAll(const std::atomic<int>* address);
+
+#endif  // EUREKA_FUTEX_H_
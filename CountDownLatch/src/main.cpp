@@ -2,11 +2,18 @@
  @ 0xCCCCCCCC
 */
 
+#include <functional>
 #include <future>
 #include <iostream>
 #include <random>
+#include <thread>
+#include <vector>
 
 #include "count_down_latch.h"
+#include "cyclic_barrier.h"
+#include "parallel_for.h"
+#include "phaser.h"
+#include "semaphore.h"
 
 const int kWorkerCount = 3;
 std::random_device rd;
@@ -23,6 +30,117 @@ void DoWork(int work_id, CountDownLatch& start_signal, CountDownLatch& done_sign
     done_signal.Countdown();
 }
 
+// Runs tasks right on the posting thread; an ActiveThread would be used in real code.
+struct InlineExecutor {
+    void PostTask(std::function<void()>&& task)
+    {
+        task();
+    }
+};
+
+void OnZeroDemo()
+{
+    InlineExecutor executor;
+    CountDownLatch sub_requests(kWorkerCount);
+    sub_requests.OnZero([] { std::cout << "all sub-requests are done, replying" << std::endl; },
+                        executor);
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < kWorkerCount; ++i) {
+        workers.emplace_back([i, &sub_requests] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100 * rn_gen(rde)));
+            std::cout << "sub-request " << i << " is done" << std::endl;
+            sub_requests.Countdown();
+        });
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ParallelForDemo()
+{
+    const int kCount = 1000000;
+    std::vector<double> values(kCount);
+    ParallelFor(0, kCount, 4096, [&values](int i) { values[i] = i * 0.5; }, Partition::STATIC);
+    auto sum = ParallelReduce(0, kCount, 4096, 0.0, [&values](int i) { return values[i]; },
+                              [](double lhs, double rhs) { return lhs + rhs; });
+    std::cout << "sum of " << kCount << " values is " << sum << std::endl;
+}
+
+void CyclicBarrierDemo()
+{
+    const int kRounds = 3;
+    int round = 0;
+    CyclicBarrier step_done(kWorkerCount, [&round] {
+        std::cout << "round " << round++ << " of simulation is done" << std::endl;
+    });
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < kWorkerCount; ++i) {
+        workers.emplace_back([&step_done] {
+            for (int r = 0; r < kRounds; ++r) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100 * rn_gen(rde)));
+                step_done.ArriveAndWait();
+            }
+        });
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void PhaserDemo()
+{
+    // The main thread registers itself as a party to keep workers from advancing too early.
+    Phaser phaser(1);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < kWorkerCount; ++i) {
+        phaser.Register();
+        workers.emplace_back([i, &phaser] {
+            // Worker i takes part in the first i + 1 phases only.
+            for (int phase = 0; phase <= i; ++phase) {
+                if (phase == i) {
+                    phaser.ArriveAndDeregister();
+                } else {
+                    phaser.ArriveAndAwaitAdvance();
+                }
+            }
+        });
+    }
+
+    while (phaser.registered_parties() > 1) {
+        auto phase = phaser.ArriveAndAwaitAdvance();
+        std::cout << "phase " << phase << " is done" << std::endl;
+    }
+
+    phaser.ArriveAndDeregister();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void SemaphoreDemo()
+{
+    // At most 2 workers hold a connection at a time.
+    Semaphore connections(2);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < kWorkerCount; ++i) {
+        workers.emplace_back([i, &connections] {
+            connections.Acquire();
+            std::cout << "worker[" << i << "] got a connection" << std::endl;
+            std::this_thread::sleep_for(std::chrono::milliseconds(100 * rn_gen(rde)));
+            connections.Release();
+        });
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
 int main()
 {
     CountDownLatch start_signal(1);
@@ -39,7 +157,10 @@ int main()
 
         std::cout << "main thread signals workers" << std::endl;
         start_signal.Countdown();
-        done_signal.Wait();
+        while (!done_signal.WaitFor(std::chrono::milliseconds(500))) {
+            std::cout << "main thread is waiting for " << done_signal.count() << " workers"
+                      << std::endl;
+        }
 
         // Make sure thread objects get destroyed before return from main.
         th1.join();
@@ -48,5 +169,11 @@ int main()
     }
     std::cout << "all workers have finished their job" << std::endl;
 
+    OnZeroDemo();
+    CyclicBarrierDemo();
+    PhaserDemo();
+    ParallelForDemo();
+    SemaphoreDemo();
+
     return 0;
 }
\ No newline at end of file
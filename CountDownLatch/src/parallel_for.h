@@ -0,0 +1,177 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+#ifndef EUREKA_PARALLEL_FOR_H_
+#define EUREKA_PARALLEL_FOR_H_
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "compiler_helper.h"
+#include "worker_pool.h"
+
+// How iterations are split among participants of a worker pool.
+enum class Partition : int {
+    // Each participant takes one contiguous block of the same size, regardless of `grain`;
+    // the cheapest, but only fits iterations of even cost.
+    STATIC,
+    // Participants keep claiming chunks of `grain` iterations from a shared cursor, until the
+    // range is exhausted.
+    DYNAMIC
+};
+
+namespace internal {
+
+// Calls `body(chunk_begin, chunk_end)` on chunks of [begin, end) assigned to `participant`.
+template<typename Index, typename Body>
+class ChunkScheduler {
+public:
+    ChunkScheduler(Index begin, Index end, Index grain, int participants, Partition partition)
+        : begin_(begin), end_(end), grain_(std::max<Index>(grain, 1)),
+          participants_(participants), partition_(partition)
+    {
+        cursor_.next.store(begin, std::memory_order_relaxed);
+    }
+
+    DISALLOW_COPY(ChunkScheduler);
+
+    DISALLOW_MOVE(ChunkScheduler);
+
+    void Run(int participant, Body& body)
+    {
+        if (partition_ == Partition::STATIC) {
+            Index count = end_ - begin_;
+            auto participants = static_cast<Index>(participants_);
+            Index block = count / participants + (count % participants != 0 ? 1 : 0);
+            Index offset = block * static_cast<Index>(participant);
+            if (offset < count) {
+                body(begin_ + offset, begin_ + std::min(count, offset + block));
+            }
+
+            return;
+        }
+
+        // The cursor never moves past `end_`, which could overflow `Index` otherwise.
+        Index chunk_begin = cursor_.next.load(std::memory_order_relaxed);
+        while (chunk_begin < end_) {
+            Index chunk_end = end_ - chunk_begin > grain_ ? chunk_begin + grain_ : end_;
+            if (cursor_.next.compare_exchange_weak(chunk_begin, chunk_end,
+                                                   std::memory_order_relaxed)) {
+                body(chunk_begin, chunk_end);
+                chunk_begin = cursor_.next.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    struct alignas(kCacheLineSize) Cursor {
+        std::atomic<Index> next;
+    };
+
+    Index begin_;
+    Index end_;
+    Index grain_;
+    int participants_;
+    Partition partition_;
+    Cursor cursor_;
+};
+
+// Slots live in a std::vector, which need not honor over-alignment before C++17; thus the
+// padding alone keeps values of neighbouring slots at least a cache line apart.
+template<typename T>
+struct PaddedAccumulator {
+    explicit PaddedAccumulator(const T& identity)
+        : value(identity)
+    {}
+
+    T value;
+    char padding[kCacheLineSize];
+};
+
+}   // namespace internal
+
+// Calls `fn(i)` for every i in [begin, end) on participants of `pool`.
+template<typename Index, typename Func>
+void ParallelFor(WorkerPool& pool, Index begin, Index end, Index grain, Func&& fn,
+                 Partition partition = Partition::DYNAMIC)
+{
+    if (begin >= end) {
+        return;
+    }
+
+    auto body = [&fn](Index chunk_begin, Index chunk_end) {
+        for (Index i = chunk_begin; i < chunk_end; ++i) {
+            fn(i);
+        }
+    };
+
+    internal::ChunkScheduler<Index, decltype(body)> scheduler(begin, end, grain,
+                                                              pool.participants(), partition);
+    pool.Run([&scheduler, &body](int participant) { scheduler.Run(participant, body); });
+}
+
+template<typename Index, typename Func>
+void ParallelFor(Index begin, Index end, Index grain, Func&& fn,
+                 Partition partition = Partition::DYNAMIC)
+{
+    ParallelFor(WorkerPool::Default(), begin, end, grain, std::forward<Func>(fn), partition);
+}
+
+// Folds `map(i)` for every i in [begin, end) with `reduce`, which must be associative and
+// commutative, since the order of folding is unspecified.
+// Every participant accumulates into its own cache-line-padded slot; slots are folded by the
+// calling thread at the end.
+template<typename Index, typename T, typename Map, typename Reduce>
+T ParallelReduce(WorkerPool& pool, Index begin, Index end, Index grain, const T& identity,
+                 Map&& map, Reduce&& reduce, Partition partition = Partition::DYNAMIC)
+{
+    if (begin >= end) {
+        return identity;
+    }
+
+    std::vector<internal::PaddedAccumulator<T>> accumulators(
+        pool.participants(), internal::PaddedAccumulator<T>(identity));
+
+    struct Body {
+        void operator()(Index chunk_begin, Index chunk_end)
+        {
+            for (Index i = chunk_begin; i < chunk_end; ++i) {
+                accumulator = reduce(std::move(accumulator), map(i));
+            }
+        }
+
+        T& accumulator;
+        Map& map;
+        Reduce& reduce;
+    };
+
+    internal::ChunkScheduler<Index, Body> scheduler(begin, end, grain, pool.participants(),
+                                                    partition);
+    pool.Run([&](int participant) {
+        Body body {accumulators[participant].value, map, reduce};
+        scheduler.Run(participant, body);
+    });
+
+    T result = identity;
+    for (auto& accumulator : accumulators) {
+        result = reduce(std::move(result), std::move(accumulator.value));
+    }
+
+    return result;
+}
+
+template<typename Index, typename T, typename Map, typename Reduce>
+T ParallelReduce(Index begin, Index end, Index grain, const T& identity, Map&& map,
+                 Reduce&& reduce, Partition partition = Partition::DYNAMIC)
+{
+    return ParallelReduce(WorkerPool::Default(), begin, end, grain, identity,
+                          std::forward<Map>(map), std::forward<Reduce>(reduce), partition);
+}
+
+#endif  // EUREKA_PARALLEL_FOR_H_
@@ -0,0 +1,130 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#include "phaser.h"
+
+#include <cassert>
+
+#include "futex.h"
+
+namespace {
+
+// Layout of the state: | phase: 32 | parties: 16 | unarrived: 16 |
+constexpr uint64_t kUnarrivedMask = 0xFFFF;
+constexpr int kPartiesShift = 16;
+constexpr int kPhaseShift = 32;
+constexpr uint64_t kOneParty = (uint64_t(1) << kPartiesShift) | 1;
+constexpr uint32_t kMaxParties = 0xFFFF;
+
+constexpr uint32_t PhaseOf(uint64_t state)
+{
+    return static_cast<uint32_t>(state >> kPhaseShift);
+}
+
+constexpr uint32_t PartiesOf(uint64_t state)
+{
+    return static_cast<uint32_t>((state >> kPartiesShift) & kUnarrivedMask);
+}
+
+constexpr uint32_t UnarrivedOf(uint64_t state)
+{
+    return static_cast<uint32_t>(state & kUnarrivedMask);
+}
+
+constexpr uint64_t MakeState(uint32_t phase, uint32_t parties, uint32_t unarrived)
+{
+    return (uint64_t(phase) << kPhaseShift) | (uint64_t(parties) << kPartiesShift) | unarrived;
+}
+
+// `advanced` counts phases advanced so far; it is wrap-around safe.
+bool HasAdvancedPast(int advanced, int phase)
+{
+    return static_cast<int32_t>(static_cast<uint32_t>(advanced) - static_cast<uint32_t>(phase)) > 0;
+}
+
+}   // namespace
+
+Phaser::Phaser(int parties)
+    : state_(MakeState(0, parties, parties)), advanced_phase_(0)
+{
+    assert(parties >= 0 && static_cast<uint32_t>(parties) <= kMaxParties);
+}
+
+int Phaser::Register()
+{
+    auto state = state_.fetch_add(kOneParty, std::memory_order_acq_rel);
+    assert(PartiesOf(state) < kMaxParties);
+    return static_cast<int>(PhaseOf(state));
+}
+
+int Phaser::Arrive()
+{
+    return DoArrive(false);
+}
+
+int Phaser::ArriveAndDeregister()
+{
+    return DoArrive(true);
+}
+
+int Phaser::ArriveAndAwaitAdvance()
+{
+    auto phase = DoArrive(false);
+    AwaitAdvance(phase);
+    return phase;
+}
+
+int Phaser::DoArrive(bool deregister)
+{
+    auto state = state_.load(std::memory_order_relaxed);
+    while (true) {
+        auto phase = PhaseOf(state);
+        auto parties = PartiesOf(state) - (deregister ? 1 : 0);
+        auto unarrived = UnarrivedOf(state);
+        assert(unarrived > 0);
+
+        // The last arrival advances the phase and resets unarrived parties at once, so that
+        // parties registering in between can never see a half-advanced state.
+        bool advancing = unarrived == 1;
+        auto next = advancing ? MakeState(phase + 1, parties, parties) :
+                                MakeState(phase, parties, unarrived - 1);
+        if (state_.compare_exchange_weak(state, next, std::memory_order_acq_rel,
+                                         std::memory_order_relaxed)) {
+            if (advancing) {
+                // Advances may be published out of order, but the counter only moves forward.
+                advanced_phase_.fetch_add(1, std::memory_order_release);
+                FutexWakeAll(&advanced_phase_);
+            }
+
+            return static_cast<int>(phase);
+        }
+    }
+}
+
+void Phaser::AwaitAdvance(int phase) const
+{
+    while (true) {
+        auto advanced = advanced_phase_.load(std::memory_order_acquire);
+        if (HasAdvancedPast(advanced, phase)) {
+            return;
+        }
+
+        FutexWait(&advanced_phase_, advanced);
+    }
+}
+
+int Phaser::phase() const noexcept
+{
+    return static_cast<int>(PhaseOf(state_.load(std::memory_order_acquire)));
+}
+
+int Phaser::registered_parties() const noexcept
+{
+    return static_cast<int>(PartiesOf(state_.load(std::memory_order_relaxed)));
+}
+
+int Phaser::unarrived_parties() const noexcept
+{
+    return static_cast<int>(UnarrivedOf(state_.load(std::memory_order_relaxed)));
+}
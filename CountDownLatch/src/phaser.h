@@ -0,0 +1,60 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+#ifndef EUREKA_PHASER_H_
+#define EUREKA_PHASER_H_
+
+#include <atomic>
+#include <cstdint>
+
+#include "compiler_helper.h"
+
+// A reusable barrier whose parties can register and deregister at any phase.
+// Phase, registered parties and unarrived parties are packed into one word, therefore an
+// arrival, a registration or the advance of a phase is a single compare-and-swap; waiters
+// park on a separate phase counter, which gets one wakeup broadcast per phase.
+// Phase numbers wrap around, and at most 65535 parties can be registered.
+class Phaser {
+public:
+    explicit Phaser(int parties = 0);
+
+    ~Phaser() = default;
+
+    DISALLOW_COPY(Phaser);
+
+    DISALLOW_MOVE(Phaser);
+
+    // Returns the phase the new party joins.
+    int Register();
+
+    // The following arrivals return the phase arrived at.
+
+    int Arrive();
+
+    int ArriveAndDeregister();
+
+    int ArriveAndAwaitAdvance();
+
+    // Blocks until the phaser has advanced past `phase`.
+    void AwaitAdvance(int phase) const;
+
+    int phase() const noexcept;
+
+    int registered_parties() const noexcept;
+
+    int unarrived_parties() const noexcept;
+
+private:
+    int DoArrive(bool deregister);
+
+private:
+    std::atomic<uint64_t> state_;
+    std::atomic<int> advanced_phase_;
+};
+
+#endif  // EUREKA_PHASER_H_
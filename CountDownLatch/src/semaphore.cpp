@@ -0,0 +1,81 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#include "semaphore.h"
+
+#include <cassert>
+
+#include "futex.h"
+
+Semaphore::Semaphore(int permits)
+    : permits_(permits), waiters_(0)
+{
+    assert(permits >= 0);
+}
+
+bool Semaphore::TryAcquire()
+{
+    auto permits = permits_.load(std::memory_order_relaxed);
+    while (permits > 0) {
+        if (permits_.compare_exchange_weak(permits, permits - 1, std::memory_order_acquire,
+                                           std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Semaphore::Acquire()
+{
+    if (TryAcquire()) {
+        return;
+    }
+
+    // Either Release() sees us counted as a waiter, or we see its permit before parking.
+    waiters_.fetch_add(1, std::memory_order_seq_cst);
+    while (!TryAcquire()) {
+        FutexWait(&permits_, 0);
+    }
+
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+bool Semaphore::TryAcquireUntil(std::chrono::steady_clock::time_point deadline)
+{
+    if (TryAcquire()) {
+        return true;
+    }
+
+    bool acquired = true;
+    waiters_.fetch_add(1, std::memory_order_seq_cst);
+    while (!TryAcquire()) {
+        auto timeout = deadline - std::chrono::steady_clock::now();
+        if (timeout <= timeout.zero()) {
+            acquired = false;
+            break;
+        }
+
+        FutexWaitFor(&permits_, 0, timeout);
+    }
+
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+    return acquired;
+}
+
+void Semaphore::Release(int n)
+{
+    assert(n > 0);
+    permits_.fetch_add(n, std::memory_order_seq_cst);
+    auto waiters = waiters_.load(std::memory_order_seq_cst);
+    if (waiters == 0) {
+        return;
+    }
+
+    if (n == 1) {
+        FutexWakeOne(&permits_);
+    } else {
+        FutexWakeAll(&permits_);
+    }
+}
@@ -0,0 +1,58 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+#ifndef EUREKA_SEMAPHORE_H_
+#define EUREKA_SEMAPHORE_H_
+
+#include <atomic>
+#include <chrono>
+
+#include "compiler_helper.h"
+
+// A counting semaphore.
+// Acquiring an available permit is a single compare-and-swap, and releasing is a single
+// atomic addition; threads park on the permit counter only if no permit is left, and
+// releasing issues a wakeup only if someone might be parked.
+// Like any semaphore, it must not be destroyed while a Release() may still be in progress.
+class Semaphore {
+public:
+    explicit Semaphore(int permits);
+
+    ~Semaphore() = default;
+
+    DISALLOW_COPY(Semaphore);
+
+    DISALLOW_MOVE(Semaphore);
+
+    bool TryAcquire();
+
+    void Acquire();
+
+    // Returns false if no permit became available within `timeout`.
+    template<typename Rep, typename Period>
+    bool TryAcquireFor(const std::chrono::duration<Rep, Period>& timeout)
+    {
+        return TryAcquireUntil(std::chrono::steady_clock::now() +
+                               std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+    }
+
+    bool TryAcquireUntil(std::chrono::steady_clock::time_point deadline);
+
+    void Release(int n = 1);
+
+    int available_permits() const noexcept
+    {
+        return permits_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<int> permits_;
+    std::atomic<int> waiters_;
+};
+
+#endif  // EUREKA_SEMAPHORE_H_
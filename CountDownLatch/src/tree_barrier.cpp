@@ -0,0 +1,105 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#include "tree_barrier.h"
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+#include "futex.h"
+
+namespace {
+
+constexpr int kSpinCount = 256;
+
+}   // namespace
+
+TreeBarrier::TreeBarrier(int parties, int fan_in)
+    : parties_(parties), fan_in_(fan_in), local_senses_(parties)
+{
+    assert(parties > 0 && fan_in > 1);
+
+    // Sizes of levels, from the leaves up to the root.
+    std::vector<int> level_sizes;
+    int children = parties;
+    do {
+        children = (children + fan_in - 1) / fan_in;
+        level_sizes.push_back(children);
+    } while (children > 1);
+
+    nodes_ = std::vector<Node>(std::accumulate(level_sizes.begin(), level_sizes.end(), 0));
+
+    int level_begin = 0;
+    children = parties;
+    for (size_t level = 0; level < level_sizes.size(); ++level) {
+        int level_size = level_sizes[level];
+        int parent_level_begin = level_begin + level_size;
+        bool is_root = level + 1 == level_sizes.size();
+        for (int i = 0; i < level_size; ++i) {
+            auto& node = nodes_[level_begin + i];
+            node.expected = std::min(fan_in, children - i * fan_in);
+            node.parent = is_root ? -1 : parent_level_begin + i / fan_in;
+            node.count.store(node.expected, std::memory_order_relaxed);
+            node.sense.store(0, std::memory_order_relaxed);
+            node.parked.store(0, std::memory_order_relaxed);
+        }
+
+        level_begin = parent_level_begin;
+        children = level_size;
+    }
+}
+
+void TreeBarrier::ArriveAndWait(int id)
+{
+    assert(id >= 0 && id < parties_);
+    int sense = local_senses_[id].value ^= 1;
+    Arrive(id / fan_in_, sense);
+}
+
+void TreeBarrier::Arrive(int node_index, int sense)
+{
+    auto& node = nodes_[node_index];
+    if (node.count.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        WaitForRelease(node, sense);
+        return;
+    }
+
+    // Nobody can arrive at this node for the next round before it is released.
+    node.count.store(node.expected, std::memory_order_relaxed);
+    if (node.parent != -1) {
+        Arrive(node.parent, sense);
+    }
+
+    Release(node, sense);
+}
+
+void TreeBarrier::Release(Node& node, int sense)
+{
+    node.sense.store(sense, std::memory_order_seq_cst);
+    if (node.parked.exchange(0, std::memory_order_seq_cst) != 0) {
+        FutexWakeAll(&node.sense);
+    }
+}
+
+// static
+void TreeBarrier::WaitForRelease(Node& node, int sense)
+{
+    for (int i = 0; i < kSpinCount; ++i) {
+        if (node.sense.load(std::memory_order_acquire) == sense) {
+            return;
+        }
+    }
+
+    // Either the releaser sees the parked mark, or we see the new sense before sleeping.
+    while (true) {
+        node.parked.store(1, std::memory_order_seq_cst);
+        auto current = node.sense.load(std::memory_order_seq_cst);
+        if (current == sense) {
+            return;
+        }
+
+        FutexWait(&node.sense, current);
+    }
+}
@@ -0,0 +1,73 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+#ifndef EUREKA_TREE_BARRIER_H_
+#define EUREKA_TREE_BARRIER_H_
+
+#include <atomic>
+#include <vector>
+
+#include "compiler_helper.h"
+
+// A reusable combining-tree barrier for many-core synchronization.
+// Participants are grouped by `fan_in` at the leaves; the last arriver of a node climbs to
+// its parent, and once the root is complete, releases flow back down the same path.
+// Each node keeps its arrival counter and its release flag on separate cache lines, so a
+// participant only contends with at most `fan_in - 1` others, and spins only on the flag of
+// its own node before parking on it.
+class TreeBarrier {
+public:
+    explicit TreeBarrier(int parties, int fan_in = 4);
+
+    ~TreeBarrier() = default;
+
+    DISALLOW_COPY(TreeBarrier);
+
+    DISALLOW_MOVE(TreeBarrier);
+
+    // Every participant must use its own and fixed id in range [0, parties).
+    void ArriveAndWait(int id);
+
+    int parties() const noexcept
+    {
+        return parties_;
+    }
+
+private:
+    // Nodes and local senses live in std::vectors, which need not honor over-alignment before
+    // C++17; thus padding alone keeps each counter and flag on a cache line of its own.
+    struct Node {
+        std::atomic<int> count;
+        int expected;
+        int parent;
+        char count_padding[kCacheLineSize];
+        std::atomic<int> sense;
+        std::atomic<int> parked;
+        char sense_padding[kCacheLineSize];
+    };
+
+    // Flipped by its owner only.
+    struct LocalSense {
+        int value;
+        char padding[kCacheLineSize];
+    };
+
+    void Arrive(int node_index, int sense);
+
+    void Release(Node& node, int sense);
+
+    static void WaitForRelease(Node& node, int sense);
+
+private:
+    const int parties_;
+    const int fan_in_;
+    std::vector<Node> nodes_;
+    std::vector<LocalSense> local_senses_;
+};
+
+#endif  // EUREKA_TREE_BARRIER_H_
@@ -0,0 +1,80 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#include "worker_pool.h"
+
+#include <algorithm>
+
+#include "count_down_latch.h"
+#include "futex.h"
+
+WorkerPool::WorkerPool(int participants)
+    : job_(nullptr), done_(nullptr), stopping_(false), generation_(0)
+{
+    if (participants <= 0) {
+        participants = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    for (int participant = 1; participant < participants; ++participant) {
+        threads_.emplace_back(&WorkerPool::WorkerMain, this, participant);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(run_mutex_);
+        stopping_ = true;
+        generation_.fetch_add(1, std::memory_order_release);
+        FutexWakeAll(&generation_);
+    }
+
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+// static
+WorkerPool& WorkerPool::Default()
+{
+    static WorkerPool pool;
+    return pool;
+}
+
+void WorkerPool::Run(const std::function<void(int)>& job)
+{
+    std::lock_guard<std::mutex> lock(run_mutex_);
+    if (threads_.empty()) {
+        job(0);
+        return;
+    }
+
+    CountDownLatch done(static_cast<int>(threads_.size()));
+    job_ = &job;
+    done_ = &done;
+    generation_.fetch_add(1, std::memory_order_release);
+    FutexWakeAll(&generation_);
+
+    job(0);
+    done.Wait();
+}
+
+void WorkerPool::WorkerMain(int participant)
+{
+    int seen_generation = 0;
+    while (true) {
+        int generation;
+        while ((generation = generation_.load(std::memory_order_acquire)) == seen_generation) {
+            FutexWait(&generation_, seen_generation);
+        }
+
+        seen_generation = generation;
+        if (stopping_) {
+            return;
+        }
+
+        (*job_)(participant);
+        done_->Countdown();
+    }
+}
@@ -0,0 +1,62 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+#ifndef EUREKA_WORKER_POOL_H_
+#define EUREKA_WORKER_POOL_H_
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "compiler_helper.h"
+
+class CountDownLatch;
+
+// A set of persistent threads for fork-join style data-parallel jobs.
+// Idle workers park on a generation counter; starting a job bumps it, with one wakeup
+// broadcast, and the joining is done by a CountDownLatch.
+class WorkerPool {
+public:
+    // `participants` includes the thread calling Run(); 0 means one per hardware thread.
+    explicit WorkerPool(int participants = 0);
+
+    ~WorkerPool();
+
+    DISALLOW_COPY(WorkerPool);
+
+    DISALLOW_MOVE(WorkerPool);
+
+    // Shared by helpers without a pool specified.
+    static WorkerPool& Default();
+
+    // Runs `job(participant)` on every participant and returns when all have finished; the
+    // calling thread takes part as participant 0.
+    // Jobs from different callers are run one after another; never call it inside a job.
+    void Run(const std::function<void(int)>& job);
+
+    int participants() const noexcept
+    {
+        return static_cast<int>(threads_.size()) + 1;
+    }
+
+private:
+    void WorkerMain(int participant);
+
+private:
+    std::vector<std::thread> threads_;
+    std::mutex run_mutex_;
+    // Published by bumping the generation.
+    const std::function<void(int)>* job_;
+    CountDownLatch* done_;
+    bool stopping_;
+    std::atomic<int> generation_;
+};
+
+#endif  // EUREKA_WORKER_POOL_H_
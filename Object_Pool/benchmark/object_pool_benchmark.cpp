@@ -0,0 +1,155 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+// Measures Get/release churn on an ObjectFactory: every thread repeatedly gets the object of a
+// random key out of a fixed set, touches it, and releases it at once, for:
+//   shared_ptr: objects from Get().
+//   handle:     objects from GetHandle().
+// Each result comes with the counters of the factory over the run, which tell how well the
+// objects are pooled, and how much the shards are contended.
+// Usage:
+//   object-pool-benchmark [--threads=1,4,16] [--keys=N] [--iterations=N]
+//                         [--free-list=N] [--retain=N] [--json]
+// Like the demo, it builds against kbase; it also needs BenchmarkHarness on its include path.
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "kbase\at_exit_manager.h"
+
+#include "benchmark_harness.h"
+
+#include "object_pool.h"
+
+namespace {
+
+struct Options {
+    std::vector<int> thread_counts {1, 4, 16};
+    int keys = 1024;
+    int iterations = 200000;
+    size_t free_list = 0;
+    size_t retain = 0;
+    bool json = false;
+};
+
+// Big enough for constructing and destroying it to be noticeable.
+// Threads getting the same key share the object, thus touching it is atomic.
+struct Payload {
+    Payload()
+        : bytes(256, 0)
+    {}
+
+    std::vector<char> bytes;
+    std::atomic<int> touches {0};
+};
+
+struct SharedPayload : Payload {};
+
+struct HandlePayload : Payload {};
+
+ObjectPoolStats operator-(const ObjectPoolStats& lhs, const ObjectPoolStats& rhs)
+{
+    ObjectPoolStats diff;
+    diff.hits = lhs.hits - rhs.hits;
+    diff.misses = lhs.misses - rhs.misses;
+    diff.constructions = lhs.constructions - rhs.constructions;
+    diff.destructions = lhs.destructions - rhs.destructions;
+    diff.live_objects = lhs.live_objects;
+    diff.construction_time = lhs.construction_time - rhs.construction_time;
+    diff.lock_contentions = lhs.lock_contentions - rhs.lock_contentions;
+    diff.lock_wait_time = lhs.lock_wait_time - rhs.lock_wait_time;
+    return diff;
+}
+
+// Runs `op(key)` for every iteration on `threads` threads, all released at once, with keys
+// drawn uniformly from `keys`; returns operations completed per second, over all threads.
+template<typename Op>
+double MeasureOps(int threads, int iterations, const std::vector<std::string>& keys, Op op)
+{
+    auto started_at = bench::RunTogether(threads, [&](int id) {
+        std::minstd_rand rng(id + 1);
+        std::uniform_int_distribution<size_t> pick(0, keys.size() - 1);
+        for (int i = 0; i < iterations; ++i) {
+            op(keys[pick(rng)]);
+        }
+    });
+
+    return static_cast<double>(threads) * iterations /
+           bench::ElapsedSeconds(started_at, bench::Clock::now());
+}
+
+void Report(const Options& options, const char* name, int threads, double ops_per_second,
+            const ObjectPoolStats& stats)
+{
+    auto requests = std::max<uint64_t>(1, stats.hits + stats.misses);
+    bench::ResultLine(options.json, name)
+        .Add("threads", threads)
+        .Add("keys", options.keys)
+        .Add("iterations", options.iterations)
+        .Add("ops_per_sec", ops_per_second)
+        .Add("hit_ratio", static_cast<double>(stats.hits) / requests, 4)
+        .Add("constructions", stats.constructions)
+        .Add("destructions", stats.destructions)
+        .Add("live_objects", stats.live_objects)
+        .Add("construction_ns", stats.construction_time.count())
+        .Add("lock_contentions", stats.lock_contentions)
+        .Add("lock_wait_ns", stats.lock_wait_time.count())
+        .Print();
+}
+
+void RunAll(const Options& options)
+{
+    std::vector<std::string> keys;
+    for (int i = 0; i < options.keys; ++i) {
+        keys.push_back("object-" + std::to_string(i));
+    }
+
+    auto shared_factory = ObjectFactory<SharedPayload>::GetInstance();
+    shared_factory->set_free_list_capacity(options.free_list);
+    shared_factory->set_retention(options.retain);
+    auto handle_factory = ObjectFactory<HandlePayload>::GetInstance();
+
+    for (auto threads : options.thread_counts) {
+        auto before = shared_factory->GetStats();
+        auto ops = MeasureOps(threads, options.iterations, keys,
+                              [shared_factory](const std::string& key) {
+                                  auto object = shared_factory->Get(key);
+                                  object->touches.fetch_add(1, std::memory_order_relaxed);
+                              });
+        Report(options, "shared_ptr", threads, ops, shared_factory->GetStats() - before);
+
+        before = handle_factory->GetStats();
+        ops = MeasureOps(threads, options.iterations, keys,
+                         [handle_factory](const std::string& key) {
+                             auto object = handle_factory->GetHandle(key);
+                             object->touches.fetch_add(1, std::memory_order_relaxed);
+                         });
+        Report(options, "handle", threads, ops, handle_factory->GetStats() - before);
+    }
+}
+
+}   // namespace
+
+int main(int argc, char* argv[])
+{
+    kbase::AtExitManager exit_manager;
+    Options options;
+    bench::FlagParser flags;
+    flags.Counts("--threads", &options.thread_counts)
+         .Number("--keys", &options.keys, 1)
+         .Number("--iterations", &options.iterations, 1)
+         .Number("--free-list", &options.free_list)
+         .Number("--retain", &options.retain)
+         .Switch("--json", &options.json);
+    if (!flags.Parse(argc, argv)) {
+        flags.PrintUsage(argv[0]);
+        return 1;
+    }
+
+    RunAll(options);
+    return 0;
+}
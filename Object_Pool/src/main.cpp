@@ -2,19 +2,65 @@
  @ 0xCCCCCCCC
 */
 
+#include <cassert>
+#include <string>
+
 #include "kbase\at_exit_manager.h"
 
 #include "object_pool.h"
 
+namespace {
+
+struct Token {};
+
+// Releasing many more objects than the retention cap, spread over all shards, must leave no
+// more than the cap retained.
+void RetentionCapTest()
+{
+    constexpr size_t kMaxRetained = 5;
+    auto factory = ObjectFactory<Token>::GetInstance();
+    factory->set_retention(kMaxRetained);
+    for (int i = 0; i < 200; ++i) {
+        factory->Get("token-" + std::to_string(i));
+        assert(factory->GetStats().live_objects <= kMaxRetained);
+    }
+
+    assert(factory->GetStats().live_objects == kMaxRetained);
+
+    // The most recently released object is among those retained.
+    auto hits = factory->GetStats().hits;
+    factory->Get("token-199");
+    assert(factory->GetStats().hits == hits + 1);
+}
+
+}   // namespace
+
 int main()
 {
     kbase::AtExitManager exit_manager;
-    auto title = ObjectFactory<std::string>::GetInstance()->Get("title");
+    auto factory = ObjectFactory<std::string>::GetInstance();
+    factory->set_free_list_capacity(16);
+    factory->set_reset_hook([](std::string& str) { str.clear(); });
+    factory->set_retention(64, std::chrono::seconds(1));
+
+    auto title = factory->Get("title");
     *title = "hello, world";
     {
-        auto pn = ObjectFactory<std::string>::GetInstance()->Get("name");
+        auto pn = factory->Get("name");
         *pn = "kingsley";
     }
 
+    // "name" was retained when released above, thus it is still "kingsley".
+    auto pn = factory->Get("name");
+
+    // Constructed as std::string(3, '!'), unless "mark" is alive already.
+    auto mark = factory->Get("mark", 3, '!');
+
+    // Handles keep the object and its refcount in a single slab block.
+    auto motto = factory->GetHandle("motto", "stay hungry");
+    auto motto_again = factory->GetHandle("motto");
+
+    RetentionCapTest();
+
     return 0;
-}
\ No newline at end of file
+}
@@ -9,16 +9,55 @@
 #ifndef OBJECT_POOL_H_
 #define OBJECT_POOL_H_
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <functional>
-#include <map>
+#include <future>
+#include <list>
 #include <memory>
 #include <mutex>
+#include <new>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "kbase\memory\singleton.h"
 
+#include "object_table.h"
+#include "slab_allocator.h"
+
 using namespace std::placeholders;
 
+// A snapshot of the counters of an ObjectFactory. Counters are collected from all shards
+// without stopping them, thus a snapshot taken under load is only roughly consistent.
+struct ObjectPoolStats {
+    // Requests served with an object that was live, retained, or under construction by others.
+    uint64_t hits = 0;
+    // Requests that had to construct an object, or to recycle one from the free list.
+    uint64_t misses = 0;
+    uint64_t constructions = 0;
+    uint64_t destructions = 0;
+    // Objects constructed and not destroyed yet, whether in use, retained or recycled.
+    uint64_t live_objects = 0;
+    std::chrono::nanoseconds construction_time {0};
+    // Acquisitions of a shard lock that had to wait for it, and the total time they waited.
+    uint64_t lock_contentions = 0;
+    std::chrono::nanoseconds lock_wait_time {0};
+};
+
+// Keys are spread over lock-striped shards, thus `Get()`s of keys in different shards don't
+// contend with each other.
+// Objects are constructed outside of any lock, and only once per key at a time: callers
+// asking for a key whose object is still under construction wait for that very object.
+// Once the last shared_ptr to an object is gone, the object is dropped, unless a retention
+// policy keeps it warm for a while; a dropped object is then deleted, or recycled.
 template<typename T>
 class ObjectFactory {
 public:
@@ -35,41 +74,730 @@ public:
         return kbase::Singleton<ObjectFactory>::instance();
     }
 
-    std::shared_ptr<T> Get(const std::string& key)
+private:
+    struct Block;
+
+public:
+    // A counted reference to an object from `GetHandle()`, which is as cheap to copy as a
+    // shared_ptr, but whose count lives in the same block as the object.
+    class Handle {
+    public:
+        Handle() noexcept
+            : block_(nullptr)
+        {}
+
+        Handle(const Handle& other) noexcept
+            : block_(other.block_)
+        {
+            if (block_) {
+                block_->ref_count.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        Handle(Handle&& other) noexcept
+            : block_(other.block_)
+        {
+            other.block_ = nullptr;
+        }
+
+        Handle& operator=(Handle other) noexcept
+        {
+            std::swap(block_, other.block_);
+            return *this;
+        }
+
+        ~Handle()
+        {
+            reset();
+        }
+
+        void reset()
+        {
+            if (block_) {
+                ObjectFactory::ReleaseBlock(block_);
+                block_ = nullptr;
+            }
+        }
+
+        T* get() const noexcept
+        {
+            return block_ ? block_->object() : nullptr;
+        }
+
+        T& operator*() const noexcept
+        {
+            return *get();
+        }
+
+        T* operator->() const noexcept
+        {
+            return get();
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return block_ != nullptr;
+        }
+
+    private:
+        friend class ObjectFactory;
+
+        // Takes over a reference already counted.
+        explicit Handle(Block* block) noexcept
+            : block_(block)
+        {}
+
+    private:
+        Block* block_;
+    };
+
+    // Constructs the object with `args` if there is neither a live nor a retained object for
+    // the key; the args are ignored otherwise.
+    // Only objects constructed without args are recycled from the free list.
+    // If the construction throws, every caller waiting for it gets the exception.
+    template<typename... Args>
+    std::shared_ptr<T> Get(KeyView key, Args&&... args)
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        std::weak_ptr<T>& object = pool_[key];
-        std::shared_ptr<T> instance = object.lock();
-        if (!instance) {
-            auto deleter = std::bind(&ObjectFactory::DeleteObject, this, key, _1);
-            instance.reset(new T(), deleter);
-            object = instance;
+        auto hash = key.Hash();
+        auto& shard = ShardFor(hash);
+        std::promise<std::shared_ptr<T>> construction;
+        std::unique_ptr<T> retained;
+        {
+            auto lock = LockShard(shard);
+            Entry& entry = shard.objects.FindOrInsert(key, hash);
+            std::shared_ptr<T> instance = entry.object.lock();
+            if (instance) {
+                Increase(shard.counters.hits);
+                return instance;
+            }
+
+            if (entry.construction.valid()) {
+                Increase(shard.counters.hits);
+                auto pending = entry.construction;
+                lock.unlock();
+                return pending.get();
+            }
+
+            // Handing out a retained object still takes an allocation, thus goes the same way
+            // as a construction.
+            if (entry.retained) {
+                Increase(shard.counters.hits);
+                retained = std::move(entry.retained_position->object);
+                shard.retained.erase(entry.retained_position);
+                retained_count_.fetch_sub(1, std::memory_order_relaxed);
+                entry.retained = false;
+            } else {
+                Increase(shard.counters.misses);
+            }
+
+            entry.construction = construction.get_future().share();
         }
 
+        std::shared_ptr<T> instance;
+        try {
+            auto deleter = std::bind(&ObjectFactory::DeleteObject, this, key.ToString(), _1);
+            auto object = retained ? std::move(retained)
+                                   : CreateObject(shard, std::forward<Args>(args)...);
+            instance.reset(object.release(), deleter);
+        } catch (...) {
+            FinishConstruction(key, hash, nullptr);
+            construction.set_exception(std::current_exception());
+            throw;
+        }
+
+        FinishConstruction(key, hash, instance);
+        construction.set_value(instance);
         return instance;
     }
 
+    // Gets the object on one of the async get threads of the factory, so that neither a
+    // construction nor waiting for one of others ties up `executor`, e.g. an ActiveThread;
+    // then runs `callback` on the executor, with either the object, or the exception thrown by
+    // the construction.
+    // Gets beyond the number of threads queue up, rather than starting threads of their own.
+    // The executor must outlive the callback.
+    template<typename Executor, typename... Args>
+    void GetAsync(KeyView key, Executor& executor,
+                  std::function<void(std::shared_ptr<T>, std::exception_ptr)> callback,
+                  Args... args)
+    {
+        PostAsyncGet([this, &executor, key = key.ToString(), callback = std::move(callback),
+                      args...]() mutable {
+            std::shared_ptr<T> instance;
+            std::exception_ptr error;
+            try {
+                instance = Get(key, std::move(args)...);
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            executor.PostTask([callback = std::move(callback), instance = std::move(instance),
+                               error] {
+                callback(instance, error);
+            });
+        });
+    }
+
+    // Like `Get()`, but the object is kept, along with its refcount and the hash of its key, in a
+    // block from the slab of its shard; thus creating an object takes no allocation once the
+    // slab has warmed up, and releasing it needs no copy of the key.
+    // Handles and the shared_ptrs from `Get()` are pooled apart, i.e. the same key refers to
+    // different objects; and objects behind handles are not recycled from the free list.
+    template<typename... Args>
+    Handle GetHandle(KeyView key, Args&&... args)
+    {
+        auto hash = key.Hash();
+        auto& shard = ShardFor(hash);
+        Block* block;
+        {
+            auto lock = LockShard(shard);
+            Block*& slot = shard.handles.FindOrInsert(key, hash);
+            if (slot && TryAddRef(slot)) {
+                Increase(shard.counters.hits);
+                block = slot;
+                Handle handle(block);
+                shard.constructed.wait(lock, [block] {
+                    return block->state != BlockState::CONSTRUCTING;
+                });
+
+                if (block->state == BlockState::READY) {
+                    return handle;
+                }
+
+                auto error = block->error;
+                lock.unlock();
+                handle.reset();
+                std::rethrow_exception(error);
+            }
+
+            // A block whose refcount has dropped to 0 is about to be released, thus it is
+            // replaced rather than revived.
+            Increase(shard.counters.misses);
+            block = shard.blocks.New(this, hash);
+            slot = block;
+        }
+
+        Handle handle(block);
+        try {
+            TimeConstruction(shard, [&] {
+                return new (&block->storage) T(std::forward<Args>(args)...);
+            });
+        } catch (...) {
+            {
+                auto lock = LockShard(shard);
+                block->state = BlockState::FAILED;
+                block->error = std::current_exception();
+                shard.handles.EraseValue(hash, block);
+            }
+
+            shard.constructed.notify_all();
+            throw;
+        }
+
+        {
+            auto lock = LockShard(shard);
+            block->state = BlockState::READY;
+        }
+
+        shard.constructed.notify_all();
+        return handle;
+    }
+
+    // Keeps up to `capacity` released objects on a free list, and reuses them for subsequent
+    // `Get()`s of any key, instead of deleting and constructing again.
+    // The capacity defaults to 0, which disables recycling.
+    // It and the reset hook below should be set up before the factory is used.
+    void set_free_list_capacity(size_t capacity)
+    {
+        std::lock_guard<std::mutex> lock(free_list_mutex_);
+        free_list_capacity_ = capacity;
+        if (free_list_.size() > capacity) {
+            Increase(shards_[0].counters.destructions, free_list_.size() - capacity);
+            free_list_.resize(capacity);
+        }
+    }
+
+    // Runs on every released object going onto the free list, to bring it back to a state
+    // fit for the next user; without one, an object is reused as it was left.
+    void set_reset_hook(std::function<void(T&)> reset_hook)
+    {
+        reset_hook_ = std::move(reset_hook);
+    }
+
+    // Up to `threads` threads, started on demand, run the gets of `GetAsync()`; defaults to the
+    // number of hardware threads.
+    // It should be set up before the factory is used.
+    void set_async_get_threads(size_t threads)
+    {
+        std::lock_guard<std::mutex> lock(async_gets_mutex_);
+        max_async_get_threads_ = std::max<size_t>(threads, 1);
+    }
+
+    // Keeps objects from `Get()` alive after their last shared_ptr is gone, so that a key asked
+    // for again soon finds its object warm: up to `max_retained` of the most recently released
+    // objects are retained, and for at most `ttl` each, if it is not zero, after which a
+    // background reaper drops them.
+    // The cap holds over the whole factory, but the LRU order is kept per shard, thus which
+    // object goes when the cap is reached is only approximately the least recently used.
+    // A `max_retained` of 0, the default, disables retention.
+    // It should be set up before the factory is used.
+    void set_retention(size_t max_retained,
+                       std::chrono::milliseconds ttl = std::chrono::milliseconds::zero())
+    {
+        StopReaper();
+        max_retained_ = max_retained;
+        retention_ttl_ = ttl;
+        if (max_retained > 0 && ttl > ttl.zero()) {
+            reaper_stopped_ = false;
+            reaper_ = std::thread(&ObjectFactory::RunReaper, this);
+        }
+    }
+
+    ObjectPoolStats GetStats() const
+    {
+        ObjectPoolStats stats;
+        uint64_t construction_ns = 0;
+        uint64_t lock_wait_ns = 0;
+        for (const auto& shard : shards_) {
+            const auto& counters = shard.counters;
+            stats.hits += counters.hits.load(std::memory_order_relaxed);
+            stats.misses += counters.misses.load(std::memory_order_relaxed);
+            stats.constructions += counters.constructions.load(std::memory_order_relaxed);
+            stats.destructions += counters.destructions.load(std::memory_order_relaxed);
+            construction_ns += counters.construction_ns.load(std::memory_order_relaxed);
+            stats.lock_contentions += counters.lock_contentions.load(std::memory_order_relaxed);
+            lock_wait_ns += counters.lock_wait_ns.load(std::memory_order_relaxed);
+        }
+
+        stats.live_objects = stats.constructions > stats.destructions ?
+                             stats.constructions - stats.destructions : 0;
+        stats.construction_time = std::chrono::nanoseconds(construction_ns);
+        stats.lock_wait_time = std::chrono::nanoseconds(lock_wait_ns);
+        return stats;
+    }
+
 private:
     ObjectFactory() = default;
 
-    ~ObjectFactory() = default;
+    ~ObjectFactory()
+    {
+        StopReaper();
+        StopAsyncGetThreads();
+    }
+
+    using Clock = std::chrono::steady_clock;
+
+    struct RetainedObject {
+        RetainedObject(const std::string& key, uint64_t hash, std::unique_ptr<T> object)
+            : key(key), hash(hash), released_at(Clock::now()), object(std::move(object))
+        {}
+
+        std::string key;
+        uint64_t hash;
+        Clock::time_point released_at;
+        std::unique_ptr<T> object;
+    };
+
+    // The most recently released object is at the front.
+    using RetainedList = std::list<RetainedObject>;
+
+    struct Entry {
+        std::weak_ptr<T> object;
+        // Valid only while the object is under construction.
+        std::shared_future<std::shared_ptr<T>> construction;
+        // Whether the object is retained, at `retained_position`.
+        bool retained = false;
+        typename RetainedList::iterator retained_position;
+    };
+
+    enum class BlockState : int {
+        CONSTRUCTING,
+        READY,
+        FAILED
+    };
+
+    struct Block {
+        Block(ObjectFactory* owner, uint64_t hash)
+            : ref_count(1), state(BlockState::CONSTRUCTING), owner(owner), hash(hash)
+        {}
+
+        T* object()
+        {
+            return reinterpret_cast<T*>(&storage);
+        }
+
+        std::atomic<int> ref_count;
+        // Written with the mutex of the shard held, and never again once out of CONSTRUCTING.
+        BlockState state;
+        ObjectFactory* owner;
+        uint64_t hash;
+        std::exception_ptr error;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    // Updated with relaxed atomics, mostly under the lock of the shard, thus they add no
+    // contention of their own.
+    struct Counters {
+        std::atomic<uint64_t> hits {0};
+        std::atomic<uint64_t> misses {0};
+        std::atomic<uint64_t> constructions {0};
+        std::atomic<uint64_t> destructions {0};
+        std::atomic<uint64_t> construction_ns {0};
+        std::atomic<uint64_t> lock_contentions {0};
+        std::atomic<uint64_t> lock_wait_ns {0};
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        Counters counters;
+        ObjectTable<Entry> objects;
+        RetainedList retained;
+        ObjectTable<Block*> handles;
+        SlabAllocator<Block> blocks;
+        // Signaled whenever the construction of an object behind handles finishes.
+        std::condition_variable constructed;
+    };
+
+    Shard& ShardFor(uint64_t hash)
+    {
+        // The table of a shard indexes with the low bits.
+        return shards_[(hash >> 32) % kShardCount];
+    }
+
+    static void Increase(std::atomic<uint64_t>& counter, uint64_t delta = 1)
+    {
+        counter.fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    static uint64_t ElapsedNanoseconds(Clock::time_point since)
+    {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - since).count());
+    }
+
+    // Times the wait only if the lock is not free right away, which keeps the uncontended
+    // path as cheap as it was.
+    static std::unique_lock<std::mutex> LockShard(Shard& shard)
+    {
+        std::unique_lock<std::mutex> lock(shard.mutex, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            auto started_at = Clock::now();
+            lock.lock();
+            Increase(shard.counters.lock_contentions);
+            Increase(shard.counters.lock_wait_ns, ElapsedNanoseconds(started_at));
+        }
+
+        return lock;
+    }
+
+    template<typename Construct>
+    static auto TimeConstruction(Shard& shard, Construct&& construct) -> decltype(construct())
+    {
+        auto started_at = Clock::now();
+        auto object = construct();
+        Increase(shard.counters.construction_ns, ElapsedNanoseconds(started_at));
+        Increase(shard.counters.constructions);
+        return object;
+    }
+
+    // Must be called with the mutex of the shard of the block held.
+    static bool TryAddRef(Block* block)
+    {
+        auto count = block->ref_count.load(std::memory_order_relaxed);
+        while (count != 0) {
+            if (block->ref_count.compare_exchange_weak(count, count + 1,
+                                                       std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    static void ReleaseBlock(Block* block)
+    {
+        if (block->ref_count.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+
+        // Nobody can take a new reference once the count has dropped to 0, thus the object
+        // can be destroyed out of the lock.
+        auto& shard = block->owner->ShardFor(block->hash);
+        if (block->state == BlockState::READY) {
+            block->object()->~T();
+            Increase(shard.counters.destructions);
+        }
+
+        auto lock = LockShard(shard);
+        shard.handles.EraseValue(block->hash, block);
+        shard.blocks.Delete(block);
+    }
+
+    std::unique_ptr<T> CreateObject(Shard& shard)
+    {
+        return AcquireObject(shard);
+    }
+
+    template<typename Arg, typename... Args>
+    std::unique_ptr<T> CreateObject(Shard& shard, Arg&& arg, Args&&... args)
+    {
+        return TimeConstruction(shard, [&] {
+            return std::make_unique<T>(std::forward<Arg>(arg), std::forward<Args>(args)...);
+        });
+    }
+
+    // Publishes the constructed object, or drops the key if the construction failed.
+    void FinishConstruction(KeyView key, uint64_t hash, const std::shared_ptr<T>& instance)
+    {
+        auto& shard = ShardFor(hash);
+        auto lock = LockShard(shard);
+
+        // The entry can't have been removed while under construction.
+        Entry* entry = shard.objects.Find(key, hash);
+        entry->construction = std::shared_future<std::shared_ptr<T>>();
+        if (instance) {
+            entry->object = instance;
+        } else {
+            shard.objects.Erase(key, hash);
+        }
+    }
+
+    std::unique_ptr<T> AcquireObject(Shard& shard)
+    {
+        if (free_list_capacity_ > 0) {
+            std::lock_guard<std::mutex> lock(free_list_mutex_);
+            if (!free_list_.empty()) {
+                auto object = std::move(free_list_.back());
+                free_list_.pop_back();
+                return object;
+            }
+        }
+
+        return TimeConstruction(shard, [] { return std::make_unique<T>(); });
+    }
 
     void DeleteObject(const std::string& key, T* ptr)
     {
-        Remove(key);
-        delete ptr;
+        std::unique_ptr<T> object(ptr);
+        std::unique_ptr<T> evicted;
+        bool over_retained = false;
+        auto hash = KeyView(key).Hash();
+        auto& shard = ShardFor(hash);
+        {
+            auto lock = LockShard(shard);
+
+            // Another `Get()` may have created, or be creating, a new object for the key, before
+            // we got the lock; or even have released that one already.
+            Entry* entry = shard.objects.Find(key, hash);
+            if (entry && entry->object.expired() && !entry->construction.valid() &&
+                !entry->retained) {
+                if (max_retained_ == 0) {
+                    shard.objects.Erase(key, hash);
+                } else {
+                    shard.retained.emplace_front(key, hash, std::move(object));
+                    entry->retained = true;
+                    entry->retained_position = shard.retained.begin();
+                    auto count = retained_count_.fetch_add(1, std::memory_order_relaxed) + 1;
+                    if (count > max_retained_) {
+                        // Drop the oldest of this shard rather than the object just retained,
+                        // or trim another shard if this one has nothing older.
+                        if (shard.retained.size() > 1) {
+                            evicted = EvictOldest(shard);
+                        } else {
+                            over_retained = true;
+                        }
+                    }
+                }
+            }
+        }
+
+        if (object) {
+            Recycle(shard, std::move(object));
+        }
+
+        if (evicted) {
+            Recycle(shard, std::move(evicted));
+        }
+
+        if (over_retained) {
+            TrimRetained(shard);
+        }
+    }
+
+    // Evicts the oldest retained objects of other shards, and of `full_shard` last, until the
+    // count of retained objects is back within the cap.
+    void TrimRetained(Shard& full_shard)
+    {
+        auto first = static_cast<size_t>(&full_shard - shards_.data());
+        for (size_t i = 1; i <= kShardCount; ++i) {
+            if (retained_count_.load(std::memory_order_relaxed) <= max_retained_) {
+                return;
+            }
+
+            auto& shard = shards_[(first + i) % kShardCount];
+            std::unique_ptr<T> evicted;
+            {
+                auto lock = LockShard(shard);
+                if (!shard.retained.empty()) {
+                    evicted = EvictOldest(shard);
+                }
+            }
+
+            if (evicted) {
+                Recycle(shard, std::move(evicted));
+            }
+        }
     }
 
-    void Remove(const std::string& key)
+    void Recycle(Shard& shard, std::unique_ptr<T> object)
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        pool_.erase(key);
+        if (free_list_capacity_ > 0) {
+            if (reset_hook_) {
+                reset_hook_(*object);
+            }
+
+            std::lock_guard<std::mutex> lock(free_list_mutex_);
+            if (free_list_.size() < free_list_capacity_) {
+                free_list_.push_back(std::move(object));
+                return;
+            }
+        }
+
+        object = nullptr;
+        Increase(shard.counters.destructions);
+    }
+
+    // Must be called with the mutex of the shard held.
+    std::unique_ptr<T> EvictOldest(Shard& shard)
+    {
+        auto& oldest = shard.retained.back();
+        shard.objects.Erase(oldest.key, oldest.hash);
+        auto object = std::move(oldest.object);
+        shard.retained.pop_back();
+        retained_count_.fetch_sub(1, std::memory_order_relaxed);
+        return object;
+    }
+
+    void RunReaper()
+    {
+        auto interval = std::max(retention_ttl_ / 2, std::chrono::milliseconds(1));
+        std::unique_lock<std::mutex> lock(reaper_mutex_);
+        while (!reaper_cv_.wait_for(lock, interval, [this] { return reaper_stopped_; })) {
+            lock.unlock();
+            DropExpired(Clock::now() - retention_ttl_);
+            lock.lock();
+        }
+    }
+
+    void DropExpired(Clock::time_point released_before)
+    {
+        std::vector<std::unique_ptr<T>> expired;
+        for (auto& shard : shards_) {
+            {
+                auto lock = LockShard(shard);
+                while (!shard.retained.empty() &&
+                       shard.retained.back().released_at < released_before) {
+                    expired.push_back(EvictOldest(shard));
+                }
+            }
+
+            for (auto& object : expired) {
+                Recycle(shard, std::move(object));
+            }
+
+            expired.clear();
+        }
+    }
+
+    // Starts another thread only if the gets queued outnumber the threads idle.
+    void PostAsyncGet(std::function<void()> get)
+    {
+        std::lock_guard<std::mutex> lock(async_gets_mutex_);
+        async_gets_.push_back(std::move(get));
+        if (async_gets_.size() > idle_async_get_threads_ &&
+            async_get_threads_.size() < max_async_get_threads_) {
+            async_get_threads_.emplace_back(&ObjectFactory::RunAsyncGets, this);
+        } else {
+            async_gets_ready_.notify_one();
+        }
+    }
+
+    // Runs gets until stopped, and until no get is left in the queue.
+    void RunAsyncGets()
+    {
+        std::unique_lock<std::mutex> lock(async_gets_mutex_);
+        while (true) {
+            ++idle_async_get_threads_;
+            async_gets_ready_.wait(lock, [this] {
+                return async_gets_stopped_ || !async_gets_.empty();
+            });
+            --idle_async_get_threads_;
+            if (async_gets_.empty()) {
+                return;
+            }
+
+            auto get = std::move(async_gets_.front());
+            async_gets_.pop_front();
+            lock.unlock();
+            get();
+            lock.lock();
+        }
+    }
+
+    // Gets already posted run to completion first.
+    void StopAsyncGetThreads()
+    {
+        std::vector<std::thread> threads;
+        {
+            std::lock_guard<std::mutex> lock(async_gets_mutex_);
+            async_gets_stopped_ = true;
+            threads.swap(async_get_threads_);
+        }
+
+        async_gets_ready_.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    void StopReaper()
+    {
+        if (!reaper_.joinable()) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(reaper_mutex_);
+            reaper_stopped_ = true;
+        }
+
+        reaper_cv_.notify_one();
+        reaper_.join();
     }
 
 private:
     friend kbase::DefaultSingletonTraits<ObjectFactory>;
-    std::mutex mutex_;
-    std::map<std::string, std::weak_ptr<T>> pool_;
+    static constexpr size_t kShardCount = 16;
+    std::array<Shard, kShardCount> shards_;
+    std::mutex free_list_mutex_;
+    std::vector<std::unique_ptr<T>> free_list_;
+    size_t free_list_capacity_ = 0;
+    std::function<void(T&)> reset_hook_;
+    size_t max_retained_ = 0;
+    // Retained objects over all shards, kept within `max_retained_`.
+    std::atomic<size_t> retained_count_ {0};
+    std::chrono::milliseconds retention_ttl_ {0};
+    std::mutex reaper_mutex_;
+    std::condition_variable reaper_cv_;
+    bool reaper_stopped_ = false;
+    std::thread reaper_;
+    std::mutex async_gets_mutex_;
+    std::condition_variable async_gets_ready_;
+    std::deque<std::function<void()>> async_gets_;
+    std::vector<std::thread> async_get_threads_;
+    size_t max_async_get_threads_ = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    size_t idle_async_get_threads_ = 0;
+    bool async_gets_stopped_ = false;
 };
 
 #endif  // OBJECT_POOL_H_
\ No newline at end of file
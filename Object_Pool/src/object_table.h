@@ -0,0 +1,230 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+#ifndef OBJECT_TABLE_H_
+#define OBJECT_TABLE_H_
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#define OBJECT_POOL_HAS_STRING_VIEW 1
+#include <string_view>
+#endif
+
+// A non-owning reference to a key, thus looking a key up never has to build a std::string.
+class KeyView {
+public:
+    KeyView(const char* str)
+        : data_(str), size_(strlen(str))
+    {}
+
+    KeyView(const char* data, size_t size)
+        : data_(data), size_(size)
+    {}
+
+    KeyView(const std::string& str)
+        : data_(str.data()), size_(str.size())
+    {}
+
+#if defined(OBJECT_POOL_HAS_STRING_VIEW)
+    KeyView(std::string_view str)
+        : data_(str.data()), size_(str.size())
+    {}
+#endif
+
+    const char* data() const
+    {
+        return data_;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    std::string ToString() const
+    {
+        return std::string(data_, size_);
+    }
+
+    bool Equals(const std::string& str) const
+    {
+        return str.size() == size_ && memcmp(str.data(), data_, size_) == 0;
+    }
+
+    // 64-bit FNV-1a, followed by the finalizer of MurmurHash3; FNV alone barely changes the
+    // high bits for keys differing only in their last bytes, and shards are picked by them.
+    uint64_t Hash() const
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        for (size_t i = 0; i < size_; ++i) {
+            hash ^= static_cast<unsigned char>(data_[i]);
+            hash *= 1099511628211ULL;
+        }
+
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+private:
+    const char* data_;
+    size_t size_;
+};
+
+// An open-addressing hash table from string keys to `Value`s, with linear probing.
+// Every slot caches the hash of its key, thus probing compares keys only on a hash match, and
+// growing never has to hash again.
+// Callers compute the hash once with `KeyView::Hash()` and pass it to every call.
+// Note that this class itself is not thread-safe, and that inserting or erasing may move
+// values around, which invalidates pointers returned earlier.
+template<typename Value>
+class ObjectTable {
+public:
+    ObjectTable()
+        : slots_(kInitialCapacity), size_(0)
+    {}
+
+    ObjectTable(const ObjectTable&) = delete;
+
+    ObjectTable& operator=(const ObjectTable&) = delete;
+
+    // Returns nullptr if the key is not present.
+    Value* Find(KeyView key, uint64_t hash)
+    {
+        auto& slot = slots_[Probe(key, hash)];
+        return slot.occupied ? &slot.value : nullptr;
+    }
+
+    // Inserts a value-initialized `Value` if the key is not present.
+    Value& FindOrInsert(KeyView key, uint64_t hash)
+    {
+        auto index = Probe(key, hash);
+        if (slots_[index].occupied) {
+            return slots_[index].value;
+        }
+
+        // Keeps the load factor at most 1/2, so that probe sequences stay short.
+        if ((size_ + 1) * 2 > slots_.size()) {
+            Grow();
+            index = Probe(key, hash);
+        }
+
+        auto& slot = slots_[index];
+        slot.occupied = true;
+        slot.hash = hash;
+        slot.key = key.ToString();
+        ++size_;
+        return slot.value;
+    }
+
+    bool Erase(KeyView key, uint64_t hash)
+    {
+        auto index = Probe(key, hash);
+        if (!slots_[index].occupied) {
+            return false;
+        }
+
+        EraseAt(index);
+        return true;
+    }
+
+    // Erases the entry whose key has the hash and whose value equals `value`; useful when the
+    // caller knows its value, e.g. a pointer, but not the key.
+    bool EraseValue(uint64_t hash, const Value& value)
+    {
+        auto mask = slots_.size() - 1;
+        for (auto index = static_cast<size_t>(hash) & mask; slots_[index].occupied;
+             index = (index + 1) & mask) {
+            if (slots_[index].hash == hash && slots_[index].value == value) {
+                EraseAt(index);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+private:
+    struct Slot {
+        bool occupied = false;
+        uint64_t hash = 0;
+        std::string key;
+        Value value {};
+    };
+
+    // Returns the index of the slot holding the key, or of the empty slot ending the probe.
+    size_t Probe(KeyView key, uint64_t hash) const
+    {
+        auto mask = slots_.size() - 1;
+        auto index = static_cast<size_t>(hash) & mask;
+        while (slots_[index].occupied &&
+               !(slots_[index].hash == hash && key.Equals(slots_[index].key))) {
+            index = (index + 1) & mask;
+        }
+
+        return index;
+    }
+
+    void EraseAt(size_t index)
+    {
+        // Shifts later entries of the probe sequence back, instead of leaving a tombstone.
+        auto mask = slots_.size() - 1;
+        auto hole = index;
+        for (auto next = (hole + 1) & mask; slots_[next].occupied; next = (next + 1) & mask) {
+            auto home = slots_[next].hash & mask;
+            bool stays = hole <= next ? (hole < home && home <= next)
+                                      : (hole < home || home <= next);
+            if (!stays) {
+                slots_[hole] = std::move(slots_[next]);
+                hole = next;
+            }
+        }
+
+        slots_[hole] = Slot();
+        --size_;
+    }
+
+    void Grow()
+    {
+        std::vector<Slot> slots(slots_.size() * 2);
+        slots.swap(slots_);
+        auto mask = slots_.size() - 1;
+        for (auto& slot : slots) {
+            if (!slot.occupied) {
+                continue;
+            }
+
+            auto index = static_cast<size_t>(slot.hash) & mask;
+            while (slots_[index].occupied) {
+                index = (index + 1) & mask;
+            }
+
+            slots_[index] = std::move(slot);
+        }
+    }
+
+private:
+    static constexpr size_t kInitialCapacity = 16;
+    std::vector<Slot> slots_;
+    size_t size_;
+};
+
+#endif  // OBJECT_TABLE_H_
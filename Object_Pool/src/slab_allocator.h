@@ -0,0 +1,87 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+#ifndef SLAB_ALLOCATOR_H_
+#define SLAB_ALLOCATOR_H_
+
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Carves objects of type T out of slabs holding `BlocksPerSlab` of them each; deleted objects
+// leave their blocks on a free list for subsequent objects, thus slabs are released only when
+// the allocator itself is destroyed, which must be after all of its objects have been deleted.
+// Note that this class itself is not thread-safe.
+template<typename T, size_t BlocksPerSlab = 64>
+class SlabAllocator {
+public:
+    SlabAllocator()
+        : free_list_(nullptr)
+    {}
+
+    ~SlabAllocator() = default;
+
+    SlabAllocator(const SlabAllocator&) = delete;
+
+    SlabAllocator& operator=(const SlabAllocator&) = delete;
+
+    template<typename... Args>
+    T* New(Args&&... args)
+    {
+        auto block = Allocate();
+        try {
+            return new (&block->storage) T(std::forward<Args>(args)...);
+        } catch (...) {
+            Free(block);
+            throw;
+        }
+    }
+
+    void Delete(T* ptr)
+    {
+        ptr->~T();
+        Free(reinterpret_cast<Block*>(ptr));
+    }
+
+private:
+    union Block {
+        Block* next;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    Block* Allocate()
+    {
+        if (!free_list_) {
+            auto slab = std::make_unique<Block[]>(BlocksPerSlab);
+            for (size_t i = 0; i < BlocksPerSlab; ++i) {
+                slab[i].next = free_list_;
+                free_list_ = &slab[i];
+            }
+
+            slabs_.push_back(std::move(slab));
+        }
+
+        auto block = free_list_;
+        free_list_ = block->next;
+        return block;
+    }
+
+    void Free(Block* block)
+    {
+        block->next = free_list_;
+        free_list_ = block;
+    }
+
+private:
+    std::vector<std::unique_ptr<Block[]>> slabs_;
+    Block* free_list_;
+};
+
+#endif  // SLAB_ALLOCATOR_H_
@@ -0,0 +1,113 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#include "intern_pool.h"
+
+#include <cstring>
+#include <limits>
+
+InternPool::InternPool()
+    : epoch_(0)
+{}
+
+bool InternPool::Key::operator==(const Key& other) const noexcept
+{
+    return hash == other.hash && size == other.size && memcmp(data, other.data, size) == 0;
+}
+
+// static
+size_t InternPool::Hash(const char* str, size_t length) noexcept
+{
+    // FNV-1a, followed by the MurmurHash3 finalizer to spread the bits evenly.
+    unsigned long long hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= static_cast<unsigned char>(str[i]);
+        hash *= 1099511628211ULL;
+    }
+
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+    return static_cast<size_t>(hash);
+}
+
+template<typename MakeCanonical>
+ThreadSafeRCString InternPool::Intern(const char* str, size_t length,
+                                      MakeCanonical make_canonical)
+{
+    Key key {str, length, Hash(str, length)};
+    // The map picks buckets by the low bits, thus shards by the high bits.
+    auto& shard = shards_[key.hash >> (std::numeric_limits<size_t>::digits - kShardBits)];
+    auto epoch = epoch_.load(std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.entries.find(key);
+    if (it == shard.entries.end()) {
+        Entry entry {make_canonical(), epoch};
+        // Canonical strings are shared by all threads using the pool.
+        entry.str.Unbias();
+        // The key must refer to the characters kept in the pool.
+        key.data = entry.str.data();
+        it = shard.entries.emplace(key, std::move(entry)).first;
+    } else {
+        it->second.last_interned_epoch = epoch;
+    }
+
+    return it->second.str;
+}
+
+ThreadSafeRCString InternPool::Intern(const char* str)
+{
+    return Intern(str, strlen(str));
+}
+
+ThreadSafeRCString InternPool::Intern(const char* str, size_t length)
+{
+    return Intern(str, length, [str, length] { return ThreadSafeRCString(str, length); });
+}
+
+ThreadSafeRCString InternPool::Intern(const ThreadSafeRCString& str)
+{
+    return Intern(str.data(), str.size(), [&str] { return str; });
+}
+
+size_t InternPool::AdvanceEpoch() noexcept
+{
+    return epoch_.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+size_t InternPool::Collect(size_t idle_epochs)
+{
+    auto epoch = epoch_.load(std::memory_order_relaxed);
+    size_t dropped = 0;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (auto it = shard.entries.begin(); it != shard.entries.end();) {
+            // Only the pool can hand out new references, and it is locked; thus an entry
+            // found unique stays so until it is dropped.
+            const auto& entry = it->second;
+            if (entry.str.Unique() && epoch - entry.last_interned_epoch >= idle_epochs) {
+                it = shard.entries.erase(it);
+                ++dropped;
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    return dropped;
+}
+
+size_t InternPool::size() const
+{
+    size_t count = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        count += shard.entries.size();
+    }
+
+    return count;
+}
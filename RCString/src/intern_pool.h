@@ -0,0 +1,94 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+
+#include "thread_safe_rc_string.h"
+
+// Hands out canonical strings: interning equal contents always yields strings sharing one
+// buffer, thus repeated keys cost the memory of a single copy, and two interned strings are
+// equal if and only if `InternPool::Same()` says so, which compares pointers only.
+// Strings are ThreadSafeRCStrings, since the pool and the strings it returns are meant to be
+// shared among threads; all member functions are thread-safe.
+// Entries live until `Collect()` drops those nobody else references; pools that never call
+// it keep every string ever interned.
+class InternPool {
+public:
+    InternPool();
+
+    ~InternPool() = default;
+
+    InternPool(const InternPool&) = delete;
+
+    InternPool& operator=(const InternPool&) = delete;
+
+    ThreadSafeRCString Intern(const char* str);
+
+    ThreadSafeRCString Intern(const char* str, size_t length);
+
+    // Adopts the buffer of `str` as the canonical one if its contents are new to the pool.
+    ThreadSafeRCString Intern(const ThreadSafeRCString& str);
+
+    // Both strings must come from the same pool.
+    static bool Same(const ThreadSafeRCString& lhs, const ThreadSafeRCString& rhs) noexcept
+    {
+        return lhs.data() == rhs.data();
+    }
+
+    // Starts a new epoch, and returns it.
+    size_t AdvanceEpoch() noexcept;
+
+    // Drops entries that nobody outside the pool references, and that have not been interned
+    // during the last `idle_epochs` epochs, so that keys only briefly unreferenced between
+    // two uses are kept. Returns the number of entries dropped.
+    size_t Collect(size_t idle_epochs = 1);
+
+    size_t size() const;
+
+private:
+    // Refers to the characters of the canonical string, or of the string being looked up,
+    // with the hash cached to spare rehashing and most comparisons.
+    struct Key {
+        const char* data;
+        size_t size;
+        size_t hash;
+
+        bool operator==(const Key& other) const noexcept;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const noexcept
+        {
+            return key.hash;
+        }
+    };
+
+    struct Entry {
+        ThreadSafeRCString str;
+        size_t last_interned_epoch;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<Key, Entry, KeyHash> entries;
+    };
+
+    static size_t Hash(const char* str, size_t length) noexcept;
+
+    // `make_canonical` creates the string to keep when the contents are new to the pool.
+    template<typename MakeCanonical>
+    ThreadSafeRCString Intern(const char* str, size_t length, MakeCanonical make_canonical);
+
+private:
+    static constexpr int kShardBits = 4;
+    static constexpr size_t kShardCount = size_t(1) << kShardBits;
+    std::array<Shard, kShardCount> shards_;
+    std::atomic<size_t> epoch_;
+};
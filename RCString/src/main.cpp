@@ -1,4 +1,12 @@
 
+#include <cassert>
+#include <future>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "intern_pool.h"
+#include "rc_rope.h"
 #include "rc_string.h"
 #include "thread_safe_rc_string.h"
 
@@ -20,6 +28,17 @@ void RCStringTest()
     std::cout << es << std::endl;
     es.Append(" is not angelababy");
     std::cout << es << std::endl;
+
+    std::cout << "---test 3---\n";
+    RCString line("key=a value long enough to be kept on the heap");
+    auto value = line.Substr(4);
+    std::cout << value << std::endl;
+    value[0] = 'A';
+    assert(line[4] == 'a');
+    auto shared_value = line.Substr(4);
+    line[4] = 'b';
+    assert(shared_value[0] == 'a');
+    std::cout << line << std::endl << value << std::endl;
 }
 
 void ThreadSafeRCStringTest()
@@ -42,8 +61,168 @@ void ThreadSafeRCStringTest()
     std::cout << es << std::endl;
 }
 
+// A proxy write after `MutableData()` must keep the data unsharable, or a copy taken next
+// would share the buffer, and see writes through the pointer.
+void MutableDataTest()
+{
+    RCString str("a string long enough to be kept on the heap");
+    auto* chars = str.MutableData();
+    str[0] = 'A';
+    RCString copy(str);
+    chars[1] = '!';
+    assert(str[1] == '!');
+    assert(copy[1] == ' ');
+
+    ThreadSafeRCString ts_str("a string shared among threads");
+    auto* ts_chars = ts_str.MutableData();
+    ts_str[0] = 'A';
+    ThreadSafeRCString ts_copy(ts_str);
+    ts_chars[1] = '!';
+    assert(ts_str[1] == '!');
+    assert(ts_copy[1] == ' ');
+    std::cout << str << std::endl << copy << std::endl;
+}
+
+void InternPoolTest()
+{
+    InternPool pool;
+    auto host = pool.Intern("Host");
+    auto another = pool.Intern(ThreadSafeRCString("Host"));
+    std::cout << host << " is interned once: " << InternPool::Same(host, another) << std::endl;
+}
+
+void RCRopeTest()
+{
+    RCRope doc("<html>");
+    auto snapshot = doc;
+    doc.Append("<body>hello rope</body>");
+    doc.Append("</html>");
+    std::cout << snapshot << std::endl << doc << std::endl;
+    std::cout << doc.Substr(6, 23) << std::endl;
+}
+
+template<typename String>
+bool Equals(const String& str, const std::string& expected)
+{
+    return std::string(str.data(), str.size()) == expected;
+}
+
+// Runs on both string classes; contents of RCString are inline, inline until appended to
+// itself, or on the heap.
+template<typename String>
+void MutationTest(const std::string& text)
+{
+    String str(text.c_str());
+    String moved(std::move(str));
+    assert(str.empty() && Equals(moved, text));
+    str = std::move(moved);
+    assert(moved.empty() && Equals(str, text));
+
+    String other("other");
+    swap(str, other);
+    assert(Equals(str, "other") && Equals(other, text));
+    str.swap(other);
+
+    String copy(str);
+    str.Reserve(text.size() * 4);
+    str.Insert(0, "<", 1);
+    str.Append(">");
+    assert(Equals(str, "<" + text + ">") && Equals(copy, text));
+
+    str.Erase(0, 1);
+    str.Erase(str.size() - 1);
+    str.Erase(1, 2);
+    assert(Equals(str, text.substr(0, 1) + text.substr(3)));
+
+    // Inserting or appending a string into itself reads it before it changes, whether the
+    // data is shared or grown in place.
+    str = copy;
+    str.Append(str.data(), str.size());
+    assert(Equals(str, text + text) && Equals(copy, text));
+    str.Append(str.data(), str.size());
+    assert(Equals(str, text + text + text + text));
+    str = copy;
+    str.Insert(1, str.data(), str.size());
+    auto inserted = text.substr(0, 1) + text + text.substr(1);
+    assert(Equals(str, inserted));
+    str.Insert(1, str.data() + 1, str.size() - 1);
+    assert(Equals(str, inserted + inserted.substr(1)));
+
+    str.Clear();
+    assert(str.empty() && Equals(copy, text));
+    str.Append("again");
+    assert(Equals(str, "again"));
+}
+
+// Dropping either end of a shared slice only narrows it, leaving the data as it is.
+void SliceEraseTest()
+{
+    std::string text("key=a value long enough to be kept on the heap");
+    RCString line(text.c_str());
+    auto value = line.Substr(4);
+    value.Erase(0, 2);
+    value.Erase(value.size() - 5);
+    assert(Equals(value, text.substr(6, text.size() - 11)) && Equals(line, text));
+    value.Erase(1, 1);
+    assert(Equals(value, text.substr(6, 1) + text.substr(8, text.size() - 13)));
+    assert(Equals(line, text));
+}
+
+// Data handed over to another thread is owned by the thread creating it, which may exit, or
+// merge the counts, while the receiver drops its copy; the receiver alone holding the data
+// writes it in place rather than cloning it.
+void BiasedHandoffTest()
+{
+    // Every release prints a line, thus rounds run silently.
+    std::cout.setstate(std::ios::badbit);
+    for (int round = 0; round < 2000; ++round) {
+        std::promise<ThreadSafeRCString> handoff;
+        std::promise<void> go;
+        std::thread consumer([&handoff, &go] {
+            auto str = handoff.get_future().get();
+            go.get_future().wait();
+            assert(str[0] == 'a');
+        });
+        std::thread producer([&handoff, &go] {
+            ThreadSafeRCString str("a string handed over to another thread");
+            handoff.set_value(str);
+            go.set_value();
+            str.Unbias();
+        });
+        producer.join();
+        consumer.join();
+    }
+
+    std::cout.clear();
+
+    std::promise<ThreadSafeRCString> handoff;
+    std::promise<void> done;
+    std::thread producer([&handoff, &done] {
+        handoff.set_value(ThreadSafeRCString("a string owned by a thread still running"));
+        done.get_future().wait();
+    });
+    auto str = handoff.get_future().get();
+    assert(str.Unique());
+    auto* chars = str.data();
+    str[0] = 'A';
+    assert(str.data() == chars);
+    done.set_value();
+    producer.join();
+    std::cout << str << std::endl;
+}
+
 int main()
 {
+    RCStringTest();
     ThreadSafeRCStringTest();
+    MutableDataTest();
+    MutationTest<RCString>("inline");
+    MutationTest<RCString>("0123456789012345678901234");
+    MutationTest<RCString>("a string long enough to be kept on the heap");
+    MutationTest<ThreadSafeRCString>("a string shared among threads");
+    SliceEraseTest();
+    BiasedHandoffTest();
+    InternPoolTest();
+    RCRopeTest();
     return 0;
 }
\ No newline at end of file
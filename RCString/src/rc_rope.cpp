@@ -0,0 +1,224 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#include "rc_rope.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+RCRope::RCRope(const char* str)
+    : RCRope(str, strlen(str))
+{}
+
+RCRope::RCRope(const char* str, size_t length)
+{
+    Append(str, length);
+}
+
+RCRope::RCRope(const RCString& str)
+{
+    Append(str);
+}
+
+// static
+RCRope::NodePtr RCRope::MakeLeaf(const RCString& chunk)
+{
+    assert(!chunk.empty());
+    return std::make_shared<Node>(Node{chunk, nullptr, nullptr, chunk.size(), 0});
+}
+
+// static
+RCRope::NodePtr RCRope::MakeConcat(const NodePtr& left, const NodePtr& right)
+{
+    return std::make_shared<Node>(Node{RCString(), left, right, left->size + right->size,
+                                       std::max(left->height, right->height) + 1});
+}
+
+// static
+RCRope::NodePtr RCRope::Balance(const NodePtr& left, const NodePtr& right)
+{
+    if (left->height > right->height + 1) {
+        if (left->left->height >= left->right->height) {
+            return MakeConcat(left->left, MakeConcat(left->right, right));
+        }
+
+        const auto& middle = left->right;
+        return MakeConcat(MakeConcat(left->left, middle->left),
+                          MakeConcat(middle->right, right));
+    }
+
+    if (right->height > left->height + 1) {
+        if (right->right->height >= right->left->height) {
+            return MakeConcat(MakeConcat(left, right->left), right->right);
+        }
+
+        const auto& middle = right->left;
+        return MakeConcat(MakeConcat(left, middle->left),
+                          MakeConcat(middle->right, right->right));
+    }
+
+    return MakeConcat(left, right);
+}
+
+// static
+RCRope::NodePtr RCRope::Join(const NodePtr& left, const NodePtr& right)
+{
+    if (!left) {
+        return right;
+    }
+
+    if (!right) {
+        return left;
+    }
+
+    // Descends along the spine of the higher tree only, thus takes O(height difference).
+    if (left->height > right->height + 1) {
+        return Balance(left->left, Join(left->right, right));
+    }
+
+    if (right->height > left->height + 1) {
+        return Balance(Join(left, right->left), right->right);
+    }
+
+    return MakeConcat(left, right);
+}
+
+// static
+RCRope::NodePtr RCRope::Take(const NodePtr& node, size_t pos, size_t count)
+{
+    if (count == 0) {
+        return nullptr;
+    }
+
+    if (pos == 0 && count == node->size) {
+        return node;
+    }
+
+    if (!node->left) {
+        return MakeLeaf(node->chunk.Substr(pos, count));
+    }
+
+    auto left_size = node->left->size;
+    if (pos + count <= left_size) {
+        return Take(node->left, pos, count);
+    }
+
+    if (pos >= left_size) {
+        return Take(node->right, pos - left_size, count);
+    }
+
+    return Join(Take(node->left, pos, left_size - pos),
+                Take(node->right, 0, pos + count - left_size));
+}
+
+// static
+RCRope::NodePtr RCRope::ReplaceLast(const NodePtr& node, const NodePtr& leaf)
+{
+    if (!node->left) {
+        return leaf;
+    }
+
+    return MakeConcat(node->left, ReplaceLast(node->right, leaf));
+}
+
+const char* RCRope::data() const
+{
+    if (!root_) {
+        return "";
+    }
+
+    if (root_->left) {
+        RCString flat;
+        ForEachChunk([&flat](RCStringView chunk) {
+            flat.Append(chunk.data(), chunk.size());
+        });
+        root_ = MakeLeaf(flat);
+    }
+
+    return root_->chunk.data();
+}
+
+void RCRope::Append(const char* str)
+{
+    Append(str, strlen(str));
+}
+
+void RCRope::Append(const char* str, size_t length)
+{
+    if (length != 0) {
+        Append(RCString(str, length));
+    }
+}
+
+void RCRope::Append(const RCString& str)
+{
+    if (str.empty()) {
+        return;
+    }
+
+    if (!root_) {
+        root_ = MakeLeaf(str);
+        return;
+    }
+
+    auto* last = root_.get();
+    while (last->left) {
+        last = last->right.get();
+    }
+
+    if (last->size + str.size() > kMaxMergedChunkSize) {
+        root_ = Join(root_, MakeLeaf(str));
+        return;
+    }
+
+    RCString merged(last->chunk);
+    merged.Append(str.data(), str.size());
+    root_ = ReplaceLast(root_, MakeLeaf(merged));
+}
+
+void RCRope::Append(const RCRope& rope)
+{
+    root_ = Join(root_, rope.root_);
+}
+
+char RCRope::operator[](size_t pos) const
+{
+    assert(pos < size());
+    auto* node = root_.get();
+    while (node->left) {
+        if (pos < node->left->size) {
+            node = node->left.get();
+        } else {
+            pos -= node->left->size;
+            node = node->right.get();
+        }
+    }
+
+    return node->chunk[pos];
+}
+
+RCRope RCRope::Substr(size_t pos, size_t count) const
+{
+    if (pos > size()) {
+        throw std::out_of_range("RCRope::Substr: pos is out of range");
+    }
+
+    RCRope rope;
+    if (root_) {
+        rope.root_ = Take(root_, pos, std::min(count, size() - pos));
+    }
+
+    return rope;
+}
+
+std::ostream& operator<<(std::ostream& os, const RCRope& rope)
+{
+    rope.ForEachChunk([&os](RCStringView chunk) {
+        os.write(chunk.data(), chunk.size());
+    });
+    return os;
+}
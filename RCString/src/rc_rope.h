@@ -0,0 +1,117 @@
+/*
+ @ 0xCCCCCCCC
+*/
+
+#pragma once
+
+#include <iosfwd>
+#include <memory>
+
+#include "rc_string.h"
+
+// A string kept as a balanced tree of RCString chunks, for contents built by many appends,
+// which would otherwise copy the whole buffer each time the string is shared.
+// Appending, concatenating and taking substrings are O(log n), and share chunks rather
+// than copying them; so do copies of a rope, which cost a refcount only.
+// The contents are flattened into a single chunk on demand only, i.e. when `data()` is
+// called; use `ForEachChunk()` to consume them, e.g. for writev(), without flattening.
+// Like RCString, this class is not thread-safe.
+class RCRope {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    RCRope() = default;
+
+    explicit RCRope(const char* str);
+
+    RCRope(const char* str, size_t length);
+
+    explicit RCRope(const RCString& str);
+
+    bool empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+    size_t size() const noexcept
+    {
+        return root_ ? root_->size : 0;
+    }
+
+    // Flattens the contents, if they are in more than one chunk.
+    const char* data() const;
+
+    void Append(const char* str);
+
+    void Append(const char* str, size_t length);
+
+    void Append(const RCString& str);
+
+    void Append(const RCRope& rope);
+
+    // Takes O(log n), without flattening.
+    char operator[](size_t pos) const;
+
+    // Returns the characters in [pos, pos + count), clamped to the size.
+    // Throws std::out_of_range if `pos` is greater than the size.
+    RCRope Substr(size_t pos, size_t count = npos) const;
+
+    // Calls `fn(RCStringView)` for every non-empty chunk, in order.
+    template<typename Fn>
+    void ForEachChunk(Fn&& fn) const
+    {
+        if (root_) {
+            VisitChunks(*root_, fn);
+        }
+    }
+
+private:
+    struct Node;
+    using NodePtr = std::shared_ptr<const Node>;
+
+    // Either a leaf having a chunk, or a concatenation of two non-empty nodes.
+    struct Node {
+        RCString chunk;
+        NodePtr left;
+        NodePtr right;
+        size_t size;
+        int height;
+    };
+
+    static NodePtr MakeLeaf(const RCString& chunk);
+
+    static NodePtr MakeConcat(const NodePtr& left, const NodePtr& right);
+
+    // Concatenates two nodes of heights differing by at most 2, rotating to rebalance.
+    static NodePtr Balance(const NodePtr& left, const NodePtr& right);
+
+    // Concatenates two balanced trees of any heights into a balanced one.
+    static NodePtr Join(const NodePtr& left, const NodePtr& right);
+
+    static NodePtr Take(const NodePtr& node, size_t pos, size_t count);
+
+    // Replaces the rightmost leaf of `node` with `leaf`.
+    static NodePtr ReplaceLast(const NodePtr& node, const NodePtr& leaf);
+
+    template<typename Fn>
+    static void VisitChunks(const Node& node, Fn& fn)
+    {
+        if (!node.left) {
+            fn(node.chunk.view());
+            return;
+        }
+
+        VisitChunks(*node.left, fn);
+        VisitChunks(*node.right, fn);
+    }
+
+private:
+    // Short appends are merged into the last chunk as long as it stays this small, which
+    // bounds both the copying per append and the number of chunks.
+    static constexpr size_t kMaxMergedChunkSize = 512;
+
+    // Flattening replaces the tree with a single chunk, with contents unchanged.
+    mutable NodePtr root_;
+};
+
+std::ostream& operator<<(std::ostream& os, const RCRope& rope);
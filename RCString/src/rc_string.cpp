@@ -6,9 +6,12 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstdlib>
 #include <cstring>
-#include <memory>
+#include <new>
+#include <stdexcept>
 #include <string>
+#include <utility>
 
 constexpr size_t kBaseSize = 4;
 
@@ -20,33 +23,35 @@ constexpr size_t RoundToMultiple(size_t num, size_t factor)
 
 class StringData {
 public:
-    explicit StringData(size_t capacity)
-        : size_(0), ref_count_(1)
-    {
-        Reserve(capacity);
-    }
+    // The header and the characters share a single allocation, with the characters right
+    // after the header.
+    static StringData* New(size_t capacity);
 
-    ~StringData()
-    {
-        assert(ref_count_ == 0 || ref_count_ == kUnsharedRefMark);
-        std::cout << "[D]: releasing StringData\n";
-    }
+    static void Delete(StringData* data) noexcept;
 
     StringData(const StringData&) = delete;
 
     StringData& operator=(const StringData&) = delete;
 
-    StringData* Clone(size_t new_capacity) const;
+    // Clones [pos, pos + length) of the content only.
+    StringData* Clone(size_t pos, size_t length, size_t new_capacity) const;
 
     void CopyData(const char* str, size_t length, size_t pos) noexcept;
 
+    // Moves the content from `pos` on backward to make room for `str`; the capacity must be
+    // large enough already.
+    void InsertData(const char* str, size_t length, size_t pos) noexcept;
+
+    void EraseData(size_t pos, size_t count) noexcept;
+
     // Ensures enought capacity (at least in size of `capacity`) for string content.
-    // Note that this function will never change the content.
-    void Reserve(size_t capacity);
+    // Note that this function will never change the content, but it may move the whole data
+    // block; thus the data returned replaces this one, which must not be used any more.
+    StringData* Reserve(size_t capacity);
 
     char* data() const noexcept
     {
-        return buffer_.get();
+        return reinterpret_cast<char*>(const_cast<StringData*>(this + 1));
     }
 
     size_t size() const noexcept
@@ -54,6 +59,19 @@ public:
         return size_;
     }
 
+    size_t capacity() const noexcept
+    {
+        return capacity_;
+    }
+
+    // Drops content beyond `size`.
+    void Truncate(size_t size) noexcept
+    {
+        assert(Unique());
+        assert(size <= size_);
+        size_ = size;
+    }
+
     bool Unique() const noexcept
     {
         return ref_count_ == 1 || ref_count_ == kUnsharedRefMark;
@@ -95,25 +113,62 @@ public:
     }
 
 private:
-    std::unique_ptr<char[]> buffer_;
+    StringData()
+        : capacity_(0), size_(0), ref_count_(1)
+    {}
+
+    ~StringData()
+    {
+        assert(ref_count_ == 0 || ref_count_ == kUnsharedRefMark);
+        std::cout << "[D]: releasing StringData\n";
+    }
+
+private:
     size_t capacity_;
     size_t size_;
     mutable unsigned int ref_count_;
     static constexpr size_t kUnsharedRefMark = static_cast<unsigned int>(-1);
 };
 
-void StringData::Reserve(size_t required_capacity)
+StringData* StringData::New(size_t capacity)
+{
+    auto new_capacity = RoundToMultiple(capacity, kBaseSize);
+    void* block = std::malloc(sizeof(StringData) + new_capacity);
+    if (!block) {
+        throw std::bad_alloc();
+    }
+
+    auto* data = new (block) StringData();
+    data->capacity_ = new_capacity;
+    return data;
+}
+
+void StringData::Delete(StringData* data) noexcept
+{
+    data->~StringData();
+    std::free(data);
+}
+
+StringData* StringData::Reserve(size_t required_capacity)
 {
     if (required_capacity <= capacity_) {
-        return;
+        return this;
     }
 
+    // The block is grown in place whenever the allocator can; otherwise realloc moves the
+    // header along with the characters. Only a unique owner reserves, thus nobody else can
+    // see the block moving.
+    assert(Unique());
     auto new_base = std::max(capacity_ * 3 / 2, required_capacity);
     auto new_capacity = RoundToMultiple(new_base, kBaseSize);
-    char* new_buf = new char[new_capacity];
-    memcpy_s(new_buf, new_capacity, buffer_.get(), size_);
-    buffer_.reset(new_buf);
-    capacity_ = new_capacity;
+    void* block = std::realloc(this, sizeof(StringData) + new_capacity);
+    if (!block) {
+        throw std::bad_alloc();
+    }
+
+    auto* data = static_cast<StringData*>(block);
+    data->capacity_ = new_capacity;
+    return data;
 }
 
 void StringData::CopyData(const char* str, size_t length, size_t pos) noexcept
@@ -121,30 +176,49 @@ void StringData::CopyData(const char* str, size_t length, size_t pos) noexcept
     assert(Unique());
     assert(pos <= size_);
     assert(pos + length <= capacity_);
-    memcpy_s(buffer_.get() + pos, capacity_, str, length);
+    memcpy_s(data() + pos, capacity_ - pos, str, length);
     size_ = std::max(pos + length, size_);
 }
 
-StringData* StringData::Clone(size_t new_capacity) const
+void StringData::InsertData(const char* str, size_t length, size_t pos) noexcept
 {
-    auto* data = new StringData(std::max(new_capacity, capacity_));
-    data->CopyData(buffer_.get(), size_, 0);
+    assert(Unique());
+    assert(pos <= size_);
+    assert(size_ + length <= capacity_);
+    memmove_s(data() + pos + length, capacity_ - pos - length, data() + pos, size_ - pos);
+    memcpy_s(data() + pos, capacity_ - pos, str, length);
+    size_ += length;
+}
+
+void StringData::EraseData(size_t pos, size_t count) noexcept
+{
+    assert(Unique());
+    assert(pos + count <= size_);
+    memmove_s(data() + pos, capacity_ - pos, data() + pos + count, size_ - pos - count);
+    size_ -= count;
+}
+
+StringData* StringData::Clone(size_t pos, size_t length, size_t new_capacity) const
+{
+    assert(pos + length <= size_);
+    auto* data = New(std::max(new_capacity, length));
+    data->CopyData(this->data() + pos, length, 0);
     return data;
 }
 
 // -*- RCString implementation -*-
 
 RCString::RCString()
-    : data_(new StringData(kBaseSize))
-{}
+{
+    set_tag(0);
+}
 
 RCString::RCString(const RCString& other)
 {
-    if (!other.data_->Unsharedable()) {
-        data_ = other.data_;
-        data_->AddRef();
+    if (other.IsInline()) {
+        memcpy_s(chars_, sizeof(chars_), other.chars_, sizeof(chars_));
     } else {
-        data_ = other.data_->Clone(other.size());
+        InitSlice(other, 0, other.size());
     }
 }
 
@@ -153,32 +227,134 @@ RCString::RCString(const char* str)
 {}
 
 RCString::RCString(const char* str, size_t length)
-    : data_(new StringData(length))
 {
-    data_->CopyData(str, length, 0);
+    if (length <= kMaxInlineSize) {
+        memcpy_s(chars_, kMaxInlineSize, str, length);
+        set_tag(static_cast<unsigned char>(length));
+    } else {
+        heap_.data = StringData::New(length);
+        heap_.data->CopyData(str, length, 0);
+        heap_.offset = 0;
+        heap_.size = length;
+        set_tag(kHeapTag);
+    }
+}
+
+RCString::RCString(RCString&& other) noexcept
+{
+    // Both representations are trivially relocatable.
+    memcpy_s(chars_, sizeof(chars_), other.chars_, sizeof(chars_));
+    other.set_tag(0);
 }
 
 RCString::~RCString()
 {
-    if (data_->Release()) {
-        delete data_;
+    if (!IsInline() && heap_.data->Release()) {
+        StringData::Delete(heap_.data);
     }
 }
 
+RCString& RCString::operator=(const RCString& other)
+{
+    if (this != &other) {
+        RCString(other).swap(*this);
+    }
+
+    return *this;
+}
+
+RCString& RCString::operator=(RCString&& other) noexcept
+{
+    if (this != &other) {
+        RCString(std::move(other)).swap(*this);
+    }
+
+    return *this;
+}
+
+void RCString::swap(RCString& other) noexcept
+{
+    char chars[sizeof(chars_)];
+    memcpy_s(chars, sizeof(chars), chars_, sizeof(chars_));
+    memcpy_s(chars_, sizeof(chars_), other.chars_, sizeof(chars_));
+    memcpy_s(other.chars_, sizeof(other.chars_), chars, sizeof(chars));
+}
+
+void RCString::InitSlice(const RCString& other, size_t pos, size_t count)
+{
+    assert(!other.IsInline());
+    const auto& source = other.heap_;
+    if (!source.data->Unsharedable()) {
+        heap_.data = source.data;
+        heap_.data->AddRef();
+        heap_.offset = source.offset + pos;
+    } else {
+        heap_.data = source.data->Clone(source.offset + pos, count, count);
+        heap_.offset = 0;
+    }
+
+    heap_.size = count;
+    set_tag(kHeapTag);
+}
+
+RCString RCString::Substr(size_t pos, size_t count) const
+{
+    if (pos > size()) {
+        throw std::out_of_range("RCString::Substr: pos is out of range");
+    }
+
+    count = std::min(count, size() - pos);
+    if (IsInline() || count <= kMaxInlineSize) {
+        return RCString(data() + pos, count);
+    }
+
+    RCString slice;
+    slice.InitSlice(*this, pos, count);
+    return slice;
+}
+
+RCString RCString::Slice(RCStringView view) const
+{
+    assert(view.data() >= data() && view.data() + view.size() <= data() + size());
+    return Substr(static_cast<size_t>(view.data() - data()), view.size());
+}
+
+void RCString::MoveToHeap(size_t capacity)
+{
+    assert(IsInline());
+    auto size = this->size();
+    auto* data = StringData::New(std::max(capacity, size));
+    data->CopyData(chars_, size, 0);
+    heap_.data = data;
+    heap_.offset = 0;
+    heap_.size = size;
+    set_tag(kHeapTag);
+}
+
 void RCString::PrepareToModify(size_t required_capacity, bool make_unsharedable)
 {
-    if (!data_->Unique()) {
-        auto* new_data = data_->Clone(required_capacity);
-        data_->Release();
-        data_ = new_data;
+    assert(!IsInline());
+    if (!heap_.data->Unique()) {
+        auto* new_data = heap_.data->Clone(heap_.offset, heap_.size, required_capacity);
+        heap_.data->Release();
+        heap_.data = new_data;
+        heap_.offset = 0;
     } else {
-        data_->Reserve(required_capacity);
+        // Content beyond the slice is not referenced by anyone else any more, neither is
+        // the room before it, which is reclaimed rather than grown past.
+        heap_.data->Truncate(heap_.offset + heap_.size);
+        if (heap_.offset != 0 && heap_.offset + required_capacity > heap_.data->capacity()) {
+            heap_.data->EraseData(0, heap_.offset);
+            heap_.offset = 0;
+        }
+
+        heap_.data = heap_.data->Reserve(heap_.offset + required_capacity);
     }
 
     if (make_unsharedable) {
-        data_->MakeUnsharedable();
+        heap_.data->MakeUnsharedable();
     } else {
-        data_->ResetSharedable();
+        heap_.data->ResetSharedable();
     }
 }
 
@@ -190,19 +366,125 @@ void RCString::Append(const char* str)
 
 void RCString::Append(const char* str, size_t length)
 {
-    auto new_size = data_->size() + length;
+    // Moving to the heap overwrites the inline characters `str` may point into, and preparing
+    // to modify may move or change heap ones.
+    if (str + length > data() && str < data() + size()) {
+        RCString copy(str, length);
+        Append(copy.data(), length);
+        return;
+    }
+
+    auto new_size = size() + length;
+    if (IsInline()) {
+        if (new_size <= kMaxInlineSize) {
+            memcpy_s(chars_ + tag(), kMaxInlineSize - tag(), str, length);
+            set_tag(static_cast<unsigned char>(new_size));
+            return;
+        }
+
+        MoveToHeap(new_size);
+    }
+
+    PrepareToModify(new_size, false);
+    heap_.data->CopyData(str, length, heap_.offset + heap_.size);
+    heap_.size = new_size;
+}
+
+void RCString::Reserve(size_t capacity)
+{
+    if (IsInline()) {
+        if (capacity <= kMaxInlineSize) {
+            return;
+        }
+
+        MoveToHeap(capacity);
+    }
+
+    PrepareToModify(std::max(capacity, size()), false);
+}
+
+void RCString::Insert(size_t pos, const char* str, size_t length)
+{
+    if (pos > size()) {
+        throw std::out_of_range("RCString::Insert: pos is out of range");
+    }
+
+    // Preparing to modify may move or change the characters `str` points into.
+    if (str + length > data() && str < data() + size()) {
+        RCString copy(str, length);
+        Insert(pos, copy.data(), length);
+        return;
+    }
+
+    auto new_size = size() + length;
+    if (IsInline()) {
+        if (new_size <= kMaxInlineSize) {
+            memmove_s(chars_ + pos + length, kMaxInlineSize - pos - length, chars_ + pos,
+                      tag() - pos);
+            memcpy_s(chars_ + pos, kMaxInlineSize - pos, str, length);
+            set_tag(static_cast<unsigned char>(new_size));
+            return;
+        }
+
+        MoveToHeap(new_size);
+    }
+
     PrepareToModify(new_size, false);
-    data_->CopyData(str, length, data_->size());
+    heap_.data->InsertData(str, length, heap_.offset + pos);
+    heap_.size = new_size;
+}
+
+void RCString::Erase(size_t pos, size_t count)
+{
+    if (pos > size()) {
+        throw std::out_of_range("RCString::Erase: pos is out of range");
+    }
+
+    count = std::min(count, size() - pos);
+    if (IsInline()) {
+        memmove_s(chars_ + pos, kMaxInlineSize - pos, chars_ + pos + count,
+                  tag() - pos - count);
+        set_tag(static_cast<unsigned char>(tag() - count));
+        return;
+    }
+
+    // Dropping either end only narrows the slice, which needs no unique data.
+    if (pos + count != heap_.size && pos != 0) {
+        PrepareToModify(heap_.size, false);
+        heap_.data->EraseData(heap_.offset + pos, count);
+    } else if (pos == 0) {
+        heap_.offset += count;
+    }
+
+    heap_.size -= count;
+}
+
+void RCString::Clear() noexcept
+{
+    if (IsInline()) {
+        set_tag(0);
+        return;
+    }
+
+    if (heap_.data->Unique()) {
+        heap_.data->ResetSharedable();
+        heap_.data->Truncate(0);
+        heap_.offset = 0;
+        heap_.size = 0;
+    } else {
+        heap_.data->Release();
+        set_tag(0);
+    }
 }
 
 const char* RCString::data() const noexcept
 {
-    return data_->data();
+    return IsInline() ? chars_ : heap_.data->data() + heap_.offset;
 }
 
 size_t RCString::size() const noexcept
 {
-    return data_->size();
+    return IsInline() ? tag() : heap_.size;
 }
 
 const char& RCString::operator[](size_t pos) const
@@ -210,10 +492,40 @@ const char& RCString::operator[](size_t pos) const
     return *(data() + pos);
 }
 
-char& RCString::operator[](size_t pos)
+RCString::CharReference RCString::operator[](size_t pos)
+{
+    return CharReference(this, pos);
+}
+
+RCString::CharReference& RCString::CharReference::operator=(char ch)
+{
+    if (str_->IsInline()) {
+        str_->chars_[pos_] = ch;
+    } else {
+        // Writing a char never reallocates, thus a pointer from `MutableData()` stays valid,
+        // and so must the unsharable mark that protects it.
+        str_->PrepareToModify(str_->size(), str_->heap_.data->Unsharedable());
+        str_->heap_.data->data()[str_->heap_.offset + pos_] = ch;
+    }
+
+    return *this;
+}
+
+char* RCString::MutableData()
 {
+    if (IsInline()) {
+        return chars_;
+    }
+
     PrepareToModify(size(), true);
-    return *(data_->data() + pos);
+    return heap_.data->data() + heap_.offset;
+}
+
+void RCString::Freeze() noexcept
+{
+    if (!IsInline() && heap_.data->Unsharedable()) {
+        heap_.data->ResetSharedable();
+    }
 }
 
 std::ostream& operator<< (std::ostream& os, const RCString& str)
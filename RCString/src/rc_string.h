@@ -4,12 +4,91 @@
 
 #pragma once
 
+#include <cassert>
 #include <iostream>
 
 class StringData;
 
+// A non-owning reference to characters of an RCString, which must outlive it.
+// It is cheap enough to be passed around while scanning a string; use `RCString::Slice()` to
+// turn it into an RCString that can be kept.
+class RCStringView {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    RCStringView() noexcept
+        : data_(nullptr), size_(0)
+    {}
+
+    RCStringView(const char* data, size_t size) noexcept
+        : data_(data), size_(size)
+    {}
+
+    bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    const char* data() const noexcept
+    {
+        return data_;
+    }
+
+    const char& operator[](size_t pos) const
+    {
+        assert(pos < size_);
+        return data_[pos];
+    }
+
+    // `pos` must be no greater than the size; `count` is clamped to the characters left.
+    RCStringView Substr(size_t pos, size_t count = npos) const
+    {
+        assert(pos <= size_);
+        return RCStringView(data_ + pos, count < size_ - pos ? count : size_ - pos);
+    }
+
+private:
+    const char* data_;
+    size_t size_;
+};
+
 class RCString {
 public:
+    // Refers to a character of a RCString; reading through it never unshares the data, and
+    // only assigning to it makes the data unique, which stays sharable afterwards.
+    class CharReference {
+    public:
+        operator char() const noexcept
+        {
+            return str_->data()[pos_];
+        }
+
+        CharReference& operator=(char ch);
+
+        CharReference& operator=(const CharReference& other)
+        {
+            return *this = static_cast<char>(other);
+        }
+
+    private:
+        friend class RCString;
+
+        CharReference(RCString* str, size_t pos) noexcept
+            : str_(str), pos_(pos)
+        {}
+
+    private:
+        RCString* str_;
+        size_t pos_;
+    };
+
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
     RCString();
 
     explicit RCString(const char* str);
@@ -18,8 +97,17 @@ public:
 
     RCString(const RCString& other);
 
+    // Takes over the contents of `other`, which becomes empty, without touching refcounts.
+    RCString(RCString&& other) noexcept;
+
     ~RCString();
 
+    RCString& operator=(const RCString& other);
+
+    RCString& operator=(RCString&& other) noexcept;
+
+    void swap(RCString& other) noexcept;
+
     bool empty() const noexcept
     {
         return size() == 0;
@@ -33,17 +121,101 @@ public:
 
     void Append(const char* str, size_t length);
 
+    // The following mutations make the data unique first, reusing it in place if it is
+    // already; capacities grow geometrically, thus repeated mutations are amortized.
+
+    // Ensures room for `capacity` characters without reallocating.
+    void Reserve(size_t capacity);
+
+    // Throws std::out_of_range if `pos` is greater than the size.
+    void Insert(size_t pos, const char* str, size_t length);
+
+    // Erases [pos, pos + count), clamped to the size.
+    // Throws std::out_of_range if `pos` is greater than the size.
+    void Erase(size_t pos, size_t count = npos);
+
+    // Keeps the data for reuse if this string is its only owner.
+    void Clear() noexcept;
+
     const char& operator[](size_t pos) const;
 
-    char& operator[](size_t pos);
+    CharReference operator[](size_t pos);
+
+    // Returns the characters for writing in place, with the data made unique.
+    // The data stays unsharable, i.e. copies of this string deep-copy, until `Freeze()` is
+    // called, which invalidates the pointer returned.
+    char* MutableData();
+
+    // Makes the data sharable again after `MutableData()`; no-op otherwise.
+    void Freeze() noexcept;
+
+    RCStringView view() const noexcept
+    {
+        return RCStringView(data(), size());
+    }
+
+    // Returns the characters in [pos, pos + count), clamped to the size, sharing the buffer
+    // with this string rather than copying, unless the result is short enough to be inline.
+    // Throws std::out_of_range if `pos` is greater than the size.
+    RCString Substr(size_t pos, size_t count = npos) const;
+
+    // Same as `Substr()`, for a view into this very string.
+    RCString Slice(RCStringView view) const;
 
 private:
+    unsigned char tag() const noexcept
+    {
+        return static_cast<unsigned char>(chars_[kMaxInlineSize]);
+    }
+
+    void set_tag(unsigned char tag) noexcept
+    {
+        chars_[kMaxInlineSize] = static_cast<char>(tag);
+    }
+
+    bool IsInline() const noexcept
+    {
+        return tag() != kHeapTag;
+    }
+
+    // Shares [pos, pos + count) of the data of `other`, which must be on the heap.
+    void InitSlice(const RCString& other, size_t pos, size_t count);
+
+    // Moves inline contents into a newly created StringData.
+    void MoveToHeap(size_t capacity);
+
     // For every mutable operations, make the underlying data **unique** first.
     // Note that performing some operations may make the underlying data unsharedable.
+    // Applies to strings on the heap only; `required_capacity` counts from the start of the
+    // string, which may not be the start of its data.
     void PrepareToModify(size_t required_capacity, bool make_unsharedable);
 
 private:
-    StringData* data_;
+    // Contents no longer than this are kept inline, and cost no allocation at all; they are
+    // copied rather than shared, which is as cheap as bumping a refcount for such sizes.
+    // The size keeps RCString itself as large as a heap string plus the tag, i.e. 4 pointers.
+    static constexpr size_t kMaxInlineSize = 4 * sizeof(void*) - 1;
+    static constexpr unsigned char kHeapTag = 0xFF;
+
+    // A heap string is the slice [offset, offset + size) of its data, which it may share
+    // with strings having other slices of the same data.
+    struct HeapString {
+        StringData* data;
+        size_t offset;
+        size_t size;
+    };
+
+    // The last byte is the tag: the size of inline contents, or kHeapTag if the contents are
+    // in `heap_`, which never overlaps the tag.
+    union {
+        HeapString heap_;
+        char chars_[kMaxInlineSize + 1];
+    };
 };
 
+inline void swap(RCString& lhs, RCString& rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
 std::ostream& operator<< (std::ostream& os, const RCString& str);
\ No newline at end of file
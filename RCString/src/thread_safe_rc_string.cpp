@@ -7,8 +7,13 @@
 #include <cassert>
 #include <algorithm>
 #include <atomic>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
 
 constexpr size_t kBaseSize = 4;
 
@@ -18,21 +23,80 @@ constexpr size_t RoundToMultiple(size_t num, size_t factor)
     return factor == 0 ? 0 : (num - 1 - (num - 1) % factor + factor);
 }
 
-class ThreadSafeStringData {
-public:
-    explicit ThreadSafeStringData(size_t capacity)
-        : size_(0), ref_count_(1)
-    {
-        Reserve(capacity);
+class ThreadSafeStringData;
+
+namespace {
+
+// The owner side of biased reference counting, one for every thread that has created data.
+// It outlives its thread as long as any data the thread owns is not merged yet.
+struct OwnerRecord {
+    OwnerRecord()
+        : pending(nullptr), alive(true), refs(1)
+    {}
+
+    // Data whose shared count went negative, waiting for the owner to merge its counts.
+    std::atomic<ThreadSafeStringData*> pending;
+    std::atomic<bool> alive;
+    // The thread itself, plus every data it owns but has not merged.
+    std::atomic<size_t> refs;
+};
+
+void AcquireOwnerRecord(OwnerRecord* record) noexcept
+{
+    record->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ReleaseOwnerRecord(OwnerRecord* record) noexcept
+{
+    if (record->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete record;
     }
+}
 
-    ~ThreadSafeStringData()
-    {
-        auto ref_count = ref_count_.load();
-        assert(ref_count == 0 || ref_count == kUnsharedRefMark);
-        std::cout << "[D]: releasing ThreadSafeStringData\n";
+// Both are trivially destructible, thus still usable while the thread is being torn down.
+thread_local OwnerRecord* current_owner = nullptr;
+thread_local bool owner_retired = false;
+
+// Retires the record of the current thread when the thread exits.
+struct OwnerRetirer {
+    ~OwnerRetirer();
+};
+
+// Returns null once the current thread has started exiting, and data created since then is
+// merged from the start.
+OwnerRecord* CurrentOwner()
+{
+    if (!current_owner && !owner_retired) {
+        thread_local OwnerRetirer retirer;
+        current_owner = new OwnerRecord();
     }
 
+    return current_owner;
+}
+
+}   // namespace
+
+// References are counted in a biased way: the thread creating the data, i.e. its owner,
+// counts its references in a plain integer, while other threads count theirs atomically, in
+// a shared count which goes negative when they release references taken by the owner.
+// Once the owner has released its references, or when its thread exits, the two counts are
+// merged into the shared one, which alone counts references from then on.
+// Other threads can read both counts as of a single moment, which tells them when they hold
+// the only reference; thus data handed over for good is reused in place, and freed by the
+// last thread holding it, without waiting for the owner.
+// Otherwise, a thread bringing an unmerged shared count below zero queues the data to the
+// owner, which merges the counts the next time it allocates or releases data.
+class ThreadSafeStringData {
+public:
+    // The header and the characters share a single allocation, with the characters right
+    // after the header.
+    static ThreadSafeStringData* New(size_t capacity);
+
+    static void Delete(ThreadSafeStringData* data) noexcept;
+
+    // Merges the counts of every data queued to `record`, and frees those no longer used.
+    static void MergePending(OwnerRecord* record) noexcept;
+
     ThreadSafeStringData(const ThreadSafeStringData&) = delete;
 
     ThreadSafeStringData& operator=(const ThreadSafeStringData&) = delete;
@@ -41,13 +105,20 @@ public:
 
     void CopyData(const char* str, size_t length, size_t pos) noexcept;
 
+    // Moves the content from `pos` on backward to make room for `str`; the capacity must be
+    // large enough already.
+    void InsertData(const char* str, size_t length, size_t pos) noexcept;
+
+    void EraseData(size_t pos, size_t count) noexcept;
+
     // Ensures enought capacity (at least in size of `capacity`) for string content.
-    // Note that this function will never change the content.
-    void Reserve(size_t capacity);
+    // Note that this function will never change the content, but it may move the whole data
+    // block; thus the data returned replaces this one, which must not be used any more.
+    ThreadSafeStringData* Reserve(size_t capacity);
 
     char* data() const noexcept
     {
-        return buffer_.get();
+        return reinterpret_cast<char*>(const_cast<ThreadSafeStringData*>(this + 1));
     }
 
     size_t size() const noexcept
@@ -55,69 +126,350 @@ public:
         return size_;
     }
 
-    // If it returns true, then the uniqueness is held until the next call that involves sharing;
-    // However, if it returns false, we can't guarantee it's not unique once the call ends.
-    bool Unique() const noexcept
+    size_t capacity() const noexcept
     {
-        auto ref_count = ref_count_.load();
-        return ref_count == 1 || ref_count == kUnsharedRefMark;
+        return capacity_;
     }
 
+    // If it returns true, then the uniqueness is held until the next call that involves sharing;
+    // However, if it returns false, we can't guarantee it's not unique once the call ends.
+    bool Unique() const noexcept;
+
     bool Unsharedable() const noexcept
     {
-        return ref_count_.load() == kUnsharedRefMark;
+        return unsharedable_;
     }
 
     // If the data is unsharedable, no more owner can share this resource.
     void MakeUnsharedable() const noexcept
     {
         assert(Unique());
-        ref_count_.store(kUnsharedRefMark);
+        unsharedable_ = true;
     }
 
     void ResetSharedable() const noexcept
     {
         assert(Unique());
-        ref_count_.store(1);
+        unsharedable_ = false;
     }
 
-    void AddRef() const noexcept
+    // Takes a plain increment on the owner thread.
+    void AddRef() const noexcept;
+
+    // The last owner should cleanup the data when this function returns true.
+    bool Release() const noexcept;
+
+    // Merges the counts now if called on the owner thread, so that the data no longer waits
+    // for the owner to be freed.
+    void Unbias() const noexcept;
+
+private:
+    explicit ThreadSafeStringData(OwnerRecord* owner) noexcept;
+
+    ~ThreadSafeStringData()
     {
-        assert(ref_count_.load() > 0);
-        ref_count_.fetch_add(1);
+        assert((shared_.load(std::memory_order_relaxed) & kQueued) == 0);
+        std::cout << "[D]: releasing ThreadSafeStringData\n";
     }
 
-    // The last owner should cleanup the data when this function returns true.
-    bool Release() const noexcept
+    bool OwnedByCurrentThread() const noexcept
     {
-        assert(ref_count_.load() > 0);
-        if (Unsharedable() || ref_count_.fetch_sub(1) - 1 == 0) {
-            return true;
-        }
+        // The biased count stays zero once merged.
+        return owner_ && owner_ == current_owner &&
+               BiasedCountOf(biased_.load(std::memory_order_relaxed)) != 0;
+    }
 
-        return false;
+    static long long CountOf(long long shared) noexcept
+    {
+        return (shared & ~kFlags) / kOneRef;
     }
 
+    static long long BiasedCountOf(unsigned long long biased) noexcept
+    {
+        return static_cast<long long>(biased & kBiasedCountMask);
+    }
+
+    // Called by the owner only, thus a plain load and store rather than an atomic
+    // read-modify-write; releasing orders the owner's accesses to the data before it.
+    // Returns the new count.
+    long long UpdateBiased(long long delta, std::memory_order order) const noexcept
+    {
+        auto biased = biased_.load(std::memory_order_relaxed);
+        biased = ((biased & ~kBiasedCountMask) + kOneBiasedUpdate) |
+                 ((biased + static_cast<unsigned long long>(delta)) & kBiasedCountMask);
+        biased_.store(biased, order);
+        return BiasedCountOf(biased);
+    }
+
+    // Reads both counts of unmerged data as of a single moment, on a thread other than the
+    // owner, and returns the number of references; or -1, with `shared` still set, if the
+    // owner changed its count in the meantime, or is merging the counts.
+    long long CountReferences(long long& shared) const noexcept;
+
+    // Folds the biased count into the shared one; must be called either on the owner thread
+    // or after the owner has exited. Returns the shared count merged.
+    long long MergeCounts() const noexcept;
+
+    // Called by the thread which brought the unmerged shared count below zero.
+    void QueueToOwner() const noexcept;
+
 private:
-    std::unique_ptr<char[]> buffer_;
     size_t capacity_;
     size_t size_;
-    mutable std::atomic<unsigned int> ref_count_;
-    static constexpr size_t kUnsharedRefMark = static_cast<unsigned int>(-1);
+    // Null for data created merged; never dereferenced once the data is merged.
+    OwnerRecord* owner_;
+    mutable ThreadSafeStringData* next_pending_;
+    // The count is kept in the upper bits, the flags in the lowest two.
+    mutable std::atomic<long long> shared_;
+    // The count of the owner in the low half, and the number of times the owner has updated
+    // it in the high half, which tells others whether it changed while they were reading.
+    mutable std::atomic<unsigned long long> biased_;
+    mutable bool unsharedable_;
+    static constexpr unsigned long long kBiasedCountMask = 0xFFFFFFFF;
+    static constexpr unsigned long long kOneBiasedUpdate = kBiasedCountMask + 1;
+    static constexpr long long kMerged = 1;
+    // Set while the data is, or is about to be, queued to its owner; such data is neither
+    // moved nor freed until it is taken off the queue, and the reference it holds to the
+    // record of its owner belongs to the queue meanwhile.
+    static constexpr long long kQueued = 2;
+    static constexpr long long kFlags = kMerged | kQueued;
+    static constexpr long long kOneRef = 4;
 };
 
-void ThreadSafeStringData::Reserve(size_t required_capacity)
+OwnerRetirer::~OwnerRetirer()
+{
+    // Data released on this thread from now on is counted as if on another thread.
+    auto* record = current_owner;
+    current_owner = nullptr;
+    owner_retired = true;
+
+    // Whoever queues data from now on merges it instead.
+    record->alive.store(false);
+    ThreadSafeStringData::MergePending(record);
+    ReleaseOwnerRecord(record);
+}
+
+ThreadSafeStringData::ThreadSafeStringData(OwnerRecord* owner) noexcept
+    : capacity_(0),
+      size_(0),
+      owner_(owner),
+      next_pending_(nullptr),
+      shared_(owner ? 0 : kOneRef | kMerged),
+      biased_(owner ? 1 : 0),
+      unsharedable_(false)
+{
+    if (owner) {
+        AcquireOwnerRecord(owner);
+    }
+}
+
+ThreadSafeStringData* ThreadSafeStringData::New(size_t capacity)
+{
+    auto* owner = CurrentOwner();
+    if (owner && owner->pending.load(std::memory_order_relaxed)) {
+        MergePending(owner);
+    }
+
+    auto new_capacity = RoundToMultiple(capacity, kBaseSize);
+    void* block = std::malloc(sizeof(ThreadSafeStringData) + new_capacity);
+    if (!block) {
+        throw std::bad_alloc();
+    }
+
+    auto* data = new (block) ThreadSafeStringData(owner);
+    data->capacity_ = new_capacity;
+    return data;
+}
+
+void ThreadSafeStringData::Delete(ThreadSafeStringData* data) noexcept
+{
+    // Data freed before being merged is unsharedable, or held by a single thread other than
+    // the owner; either way not queued, thus still holding its reference to the record.
+    bool merged = (data->shared_.load(std::memory_order_relaxed) & kMerged) != 0;
+    auto* owner = data->owner_;
+    data->~ThreadSafeStringData();
+    std::free(data);
+    if (!merged) {
+        ReleaseOwnerRecord(owner);
+    }
+}
+
+long long ThreadSafeStringData::CountReferences(long long& shared) const noexcept
+{
+    auto biased = biased_.load(std::memory_order_acquire);
+    shared = shared_.load(std::memory_order_acquire);
+    if (biased_.load(std::memory_order_acquire) != biased || (shared & kMerged) ||
+        BiasedCountOf(biased) == 0) {
+        return -1;
+    }
+
+    return BiasedCountOf(biased) + CountOf(shared);
+}
+
+bool ThreadSafeStringData::Unique() const noexcept
+{
+    if (unsharedable_) {
+        return true;
+    }
+
+    if (OwnedByCurrentThread()) {
+        auto shared = shared_.load(std::memory_order_acquire);
+        return (shared & kQueued) == 0 &&
+               BiasedCountOf(biased_.load(std::memory_order_relaxed)) + CountOf(shared) == 1;
+    }
+
+    long long shared;
+    auto count = CountReferences(shared);
+    if (shared & kQueued) {
+        return false;
+    }
+
+    if (shared & kMerged) {
+        return shared == (kOneRef | kMerged);
+    }
+
+    // A thread holding the only reference keeps it so, since nobody else, not even the
+    // owner, can take another one from it meanwhile.
+    return count == 1;
+}
+
+void ThreadSafeStringData::AddRef() const noexcept
+{
+    if (OwnedByCurrentThread()) {
+        UpdateBiased(1, std::memory_order_relaxed);
+    } else {
+        shared_.fetch_add(kOneRef, std::memory_order_relaxed);
+    }
+}
+
+bool ThreadSafeStringData::Release() const noexcept
+{
+    if (unsharedable_) {
+        return true;
+    }
+
+    // Merges what other threads have queued to the owner, which may include this data, so
+    // that an owner no longer allocating still frees them.
+    if (OwnedByCurrentThread() && owner_->pending.load(std::memory_order_relaxed)) {
+        MergePending(owner_);
+    }
+
+    if (OwnedByCurrentThread()) {
+        return UpdateBiased(-1, std::memory_order_release) == 0 && MergeCounts() == kMerged;
+    }
+
+    // The last reference to data handed over for good frees it right away.
+    long long shared;
+    if (CountReferences(shared) == 1 && (shared & kQueued) == 0) {
+        return true;
+    }
+
+    long long desired;
+    bool queue;
+    do {
+        desired = shared - kOneRef;
+        queue = (shared & kFlags) == 0 && desired < 0;
+        if (queue) {
+            desired |= kQueued;
+        }
+    } while (!shared_.compare_exchange_weak(shared, desired, std::memory_order_acq_rel,
+                                            std::memory_order_relaxed));
+
+    if (queue) {
+        QueueToOwner();
+        return false;
+    }
+
+    return desired == kMerged;
+}
+
+void ThreadSafeStringData::Unbias() const noexcept
+{
+    if (OwnedByCurrentThread()) {
+        MergeCounts();
+    }
+}
+
+long long ThreadSafeStringData::MergeCounts() const noexcept
+{
+    auto count = BiasedCountOf(biased_.load(std::memory_order_relaxed));
+    UpdateBiased(-count, std::memory_order_release);
+    auto biased = count * kOneRef;
+    auto shared = shared_.load(std::memory_order_relaxed);
+    while (!shared_.compare_exchange_weak(shared, (shared + biased) | kMerged,
+                                          std::memory_order_acq_rel,
+                                          std::memory_order_relaxed)) {}
+
+    // Queued data keeps the reference to the record until it is taken off the queue.
+    if ((shared & kQueued) == 0) {
+        ReleaseOwnerRecord(owner_);
+    }
+
+    return (shared + biased) | kMerged;
+}
+
+void ThreadSafeStringData::QueueToOwner() const noexcept
+{
+    // The queue holds a reference to the record already; but once pushed, the data may be
+    // taken off the queue, and the reference released, at any time.
+    auto* record = owner_;
+    AcquireOwnerRecord(record);
+    auto* self = const_cast<ThreadSafeStringData*>(this);
+    next_pending_ = record->pending.load(std::memory_order_relaxed);
+    while (!record->pending.compare_exchange_weak(next_pending_, self)) {}
+
+    if (!record->alive.load()) {
+        MergePending(record);
+    }
+
+    ReleaseOwnerRecord(record);
+}
+
+// static
+void ThreadSafeStringData::MergePending(OwnerRecord* record) noexcept
+{
+    auto* data = record->pending.exchange(nullptr);
+    while (data) {
+        auto* next = data->next_pending_;
+        if ((data->shared_.load(std::memory_order_relaxed) & kMerged) == 0) {
+            data->MergeCounts();
+        }
+
+        auto shared = data->shared_.load(std::memory_order_relaxed);
+        while (!data->shared_.compare_exchange_weak(shared, shared & ~kQueued,
+                                                    std::memory_order_acq_rel,
+                                                    std::memory_order_relaxed)) {}
+
+        // Callers hold references to the record themselves, thus this is never the last one.
+        ReleaseOwnerRecord(record);
+        if ((shared & ~kQueued) == kMerged) {
+            Delete(data);
+        }
+
+        data = next;
+    }
+}
+
+ThreadSafeStringData* ThreadSafeStringData::Reserve(size_t required_capacity)
 {
     if (required_capacity <= capacity_) {
-        return;
+        return this;
     }
 
+    // The block is grown in place whenever the allocator can; otherwise realloc moves the
+    // header along with the characters. Only a unique owner reserves, thus nobody else can
+    // see the block moving.
+    assert(Unique());
     auto new_base = std::max(capacity_ * 3 / 2, required_capacity);
     auto new_capacity = RoundToMultiple(new_base, kBaseSize);
-    char* new_buf = new char[new_capacity];
-    memcpy_s(new_buf, new_capacity, buffer_.get(), size_);
-    buffer_.reset(new_buf);
-    capacity_ = new_capacity;
+    void* block = std::realloc(this, sizeof(ThreadSafeStringData) + new_capacity);
+    if (!block) {
+        throw std::bad_alloc();
+    }
+
+    auto* data = static_cast<ThreadSafeStringData*>(block);
+    data->capacity_ = new_capacity;
+    return data;
 }
 
 void ThreadSafeStringData::CopyData(const char* str, size_t length, size_t pos) noexcept
@@ -125,21 +477,39 @@ void ThreadSafeStringData::CopyData(const char* str, size_t length, size_t pos)
     assert(Unique());
     assert(pos <= size_);
     assert(pos + length <= capacity_);
-    memcpy_s(buffer_.get() + pos, capacity_, str, length);
+    memcpy_s(data() + pos, capacity_ - pos, str, length);
     size_ = std::max(pos + length, size_);
 }
 
+void ThreadSafeStringData::InsertData(const char* str, size_t length, size_t pos) noexcept
+{
+    assert(Unique());
+    assert(pos <= size_);
+    assert(size_ + length <= capacity_);
+    memmove_s(data() + pos + length, capacity_ - pos - length, data() + pos, size_ - pos);
+    memcpy_s(data() + pos, capacity_ - pos, str, length);
+    size_ += length;
+}
+
+void ThreadSafeStringData::EraseData(size_t pos, size_t count) noexcept
+{
+    assert(Unique());
+    assert(pos + count <= size_);
+    memmove_s(data() + pos, capacity_ - pos, data() + pos + count, size_ - pos - count);
+    size_ -= count;
+}
+
 ThreadSafeStringData* ThreadSafeStringData::Clone(size_t new_capacity) const
 {
-    auto* data = new ThreadSafeStringData(std::max(new_capacity, capacity_));
-    data->CopyData(buffer_.get(), size_, 0);
+    auto* data = New(std::max(new_capacity, capacity_));
+    data->CopyData(this->data(), size_, 0);
     return data;
 }
 
 // -*- ThreadSafeRCString -*-
 
 ThreadSafeRCString::ThreadSafeRCString()
-    : data_(new ThreadSafeStringData(kBaseSize))
+    : data_(nullptr)
 {}
 
 ThreadSafeRCString::ThreadSafeRCString(const char* str)
@@ -147,14 +517,16 @@ ThreadSafeRCString::ThreadSafeRCString(const char* str)
 {}
 
 ThreadSafeRCString::ThreadSafeRCString(const char* str, size_t length)
-    : data_(new ThreadSafeStringData(length))
+    : data_(ThreadSafeStringData::New(length))
 {
     data_->CopyData(str, length, 0);
 }
 
 ThreadSafeRCString::ThreadSafeRCString(const ThreadSafeRCString& other)
 {
-    if (!other.data_->Unsharedable()) {
+    if (!other.data_) {
+        data_ = nullptr;
+    } else if (!other.data_->Unsharedable()) {
         data_ = other.data_;
         data_->AddRef();
     } else {
@@ -162,21 +534,62 @@ ThreadSafeRCString::ThreadSafeRCString(const ThreadSafeRCString& other)
     }
 }
 
+ThreadSafeRCString::ThreadSafeRCString(ThreadSafeRCString&& other) noexcept
+    : data_(other.data_)
+{
+    other.data_ = nullptr;
+}
+
 ThreadSafeRCString::~ThreadSafeRCString()
 {
-    if (data_->Release()) {
-        delete data_;
+    if (data_ && data_->Release()) {
+        ThreadSafeStringData::Delete(data_);
     }
 }
 
+ThreadSafeRCString& ThreadSafeRCString::operator=(const ThreadSafeRCString& other)
+{
+    if (this != &other) {
+        ThreadSafeRCString(other).swap(*this);
+    }
+
+    return *this;
+}
+
+ThreadSafeRCString& ThreadSafeRCString::operator=(ThreadSafeRCString&& other) noexcept
+{
+    if (this != &other) {
+        ThreadSafeRCString(std::move(other)).swap(*this);
+    }
+
+    return *this;
+}
+
+void ThreadSafeRCString::swap(ThreadSafeRCString& other) noexcept
+{
+    std::swap(data_, other.data_);
+}
+
 size_t ThreadSafeRCString::size() const noexcept
 {
-    return data_->size();
+    return data_ ? data_->size() : 0;
 }
 
 const char* ThreadSafeRCString::data() const noexcept
 {
-    return data_->data();
+    return data_ ? data_->data() : "";
+}
+
+bool ThreadSafeRCString::Unique() const noexcept
+{
+    return !data_ || data_->Unique();
+}
+
+void ThreadSafeRCString::Unbias() const noexcept
+{
+    if (data_) {
+        data_->Unbias();
+    }
 }
 
 void ThreadSafeRCString::Append(const char* str)
@@ -186,34 +599,118 @@ void ThreadSafeRCString::Append(const char* str)
 
 void ThreadSafeRCString::Append(const char* str, size_t length)
 {
+    // Preparing to modify may move or change the characters `str` points into.
+    if (str + length > data() && str < data() + size()) {
+        ThreadSafeRCString copy(str, length);
+        Append(copy.data(), length);
+        return;
+    }
+
     auto new_size_required = size() + length;
     PrepareToModify(new_size_required, false);
     data_->CopyData(str, length, data_->size());
 }
 
+void ThreadSafeRCString::Reserve(size_t capacity)
+{
+    PrepareToModify(std::max(capacity, size()), false);
+}
+
+void ThreadSafeRCString::Insert(size_t pos, const char* str, size_t length)
+{
+    if (pos > size()) {
+        throw std::out_of_range("ThreadSafeRCString::Insert: pos is out of range");
+    }
+
+    // Preparing to modify may move or change the characters `str` points into.
+    if (str + length > data() && str < data() + size()) {
+        ThreadSafeRCString copy(str, length);
+        Insert(pos, copy.data(), length);
+        return;
+    }
+
+    PrepareToModify(size() + length, false);
+    data_->InsertData(str, length, pos);
+}
+
+void ThreadSafeRCString::Erase(size_t pos, size_t count)
+{
+    if (pos > size()) {
+        throw std::out_of_range("ThreadSafeRCString::Erase: pos is out of range");
+    }
+
+    count = std::min(count, size() - pos);
+    if (count != 0) {
+        PrepareToModify(size(), false);
+        data_->EraseData(pos, count);
+    }
+}
+
+void ThreadSafeRCString::Clear() noexcept
+{
+    if (!data_) {
+        return;
+    }
+
+    if (data_->Unique()) {
+        data_->ResetSharedable();
+        data_->EraseData(0, data_->size());
+    } else {
+        // Other owners may have released the data in the meantime.
+        if (data_->Release()) {
+            ThreadSafeStringData::Delete(data_);
+        }
+
+        data_ = nullptr;
+    }
+}
+
 const char& ThreadSafeRCString::operator[](size_t pos) const
 {
     return *(data_->data() + pos);
 }
 
-char& ThreadSafeRCString::operator[](size_t pos)
+ThreadSafeRCString::CharReference ThreadSafeRCString::operator[](size_t pos)
+{
+    return CharReference(this, pos);
+}
+
+ThreadSafeRCString::CharReference& ThreadSafeRCString::CharReference::operator=(char ch)
+{
+    // Writing a char never reallocates, thus a pointer from `MutableData()` stays valid, and
+    // so must the unsharable mark that protects it.
+    str_->PrepareToModify(str_->size(), str_->data_ && str_->data_->Unsharedable());
+    str_->data_->data()[pos_] = ch;
+    return *this;
+}
+
+char* ThreadSafeRCString::MutableData()
 {
     PrepareToModify(size(), true);
-    return *(data_->data() + pos);
+    return data_->data();
+}
+
+void ThreadSafeRCString::Freeze() noexcept
+{
+    if (data_ && data_->Unsharedable()) {
+        data_->ResetSharedable();
+    }
 }
 
 void ThreadSafeRCString::PrepareToModify(size_t required_capacity, bool make_unsharedable)
 {
-    if (!data_->Unique()) {
+    if (!data_) {
+        data_ = ThreadSafeStringData::New(std::max(required_capacity, kBaseSize));
+    } else if (!data_->Unique()) {
         auto new_data = data_->Clone(required_capacity);
         // At this moment, current string might be the sole owner of the underlying data.
         if (data_->Release()) {
-            delete  data_;
+            ThreadSafeStringData::Delete(data_);
         }
 
         data_ = new_data;
     } else {
-        data_->Reserve(required_capacity);
+        data_ = data_->Reserve(required_capacity);
     }
 
     if (make_unsharedable) {
@@ -227,4 +724,4 @@ std::ostream& operator<<(std::ostream& os, const ThreadSafeRCString& str)
 {
     os.write(str.data(), str.size());
     return os;
-}
\ No newline at end of file
+}
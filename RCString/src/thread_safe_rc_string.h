@@ -10,6 +10,36 @@ class ThreadSafeStringData;
 
 class ThreadSafeRCString {
 public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    // Refers to a character of a ThreadSafeRCString; reading through it never unshares the data, and
+    // only assigning to it makes the data unique, which stays sharable afterwards.
+    class CharReference {
+    public:
+        operator char() const noexcept
+        {
+            return str_->data()[pos_];
+        }
+
+        CharReference& operator=(char ch);
+
+        CharReference& operator=(const CharReference& other)
+        {
+            return *this = static_cast<char>(other);
+        }
+
+    private:
+        friend class ThreadSafeRCString;
+
+        CharReference(ThreadSafeRCString* str, size_t pos) noexcept
+            : str_(str), pos_(pos)
+        {}
+
+    private:
+        ThreadSafeRCString* str_;
+        size_t pos_;
+    };
+
     ThreadSafeRCString();
 
     explicit ThreadSafeRCString(const char* str);
@@ -18,8 +48,17 @@ public:
 
     ThreadSafeRCString(const ThreadSafeRCString& other);
 
+    // Takes over the contents of `other`, which becomes empty, without touching refcounts.
+    ThreadSafeRCString(ThreadSafeRCString&& other) noexcept;
+
     ~ThreadSafeRCString();
 
+    ThreadSafeRCString& operator=(const ThreadSafeRCString& other);
+
+    ThreadSafeRCString& operator=(ThreadSafeRCString&& other) noexcept;
+
+    void swap(ThreadSafeRCString& other) noexcept;
+
     bool empty() const noexcept
     {
         return size() == 0;
@@ -29,13 +68,46 @@ public:
 
     const char* data() const noexcept;
 
+    // Returns true if no other string shares the data with this one.
+    bool Unique() const noexcept;
+
+    // References to the data are counted with plain integers on the thread creating it, and
+    // atomically elsewhere. Call this on the creating thread for strings kept for, or handed
+    // over to, other threads: all references are then counted atomically, and the data no
+    // longer depends on the creating thread to be freed.
+    void Unbias() const noexcept;
+
     void Append(const char* str);
 
     void Append(const char* str, size_t length);
 
+    // The following mutations make the data unique first, reusing it in place if it is
+    // already; capacities grow geometrically, thus repeated mutations are amortized.
+
+    // Ensures room for `capacity` characters without reallocating.
+    void Reserve(size_t capacity);
+
+    // Throws std::out_of_range if `pos` is greater than the size.
+    void Insert(size_t pos, const char* str, size_t length);
+
+    // Erases [pos, pos + count), clamped to the size.
+    // Throws std::out_of_range if `pos` is greater than the size.
+    void Erase(size_t pos, size_t count = npos);
+
+    // Keeps the data for reuse if this string is its only owner.
+    void Clear() noexcept;
+
     const char& operator[](size_t pos) const;
 
-    char& operator[](size_t pos);
+    CharReference operator[](size_t pos);
+
+    // Returns the characters for writing in place, with the data made unique.
+    // The data stays unsharable, i.e. copies of this string deep-copy, until `Freeze()` is
+    // called, which invalidates the pointer returned.
+    char* MutableData();
+
+    // Makes the data sharable again after `MutableData()`; no-op otherwise.
+    void Freeze() noexcept;
 
 private:
     // For every mutable operations, make the underlying data **unique** first.
@@ -43,7 +115,14 @@ private:
     void PrepareToModify(size_t required_capacity, bool make_unsharedable);
 
 private:
+    // Null for strings that have never had data, or have been moved from; they cost no
+    // allocation at all.
     ThreadSafeStringData* data_;
 };
 
+inline void swap(ThreadSafeRCString& lhs, ThreadSafeRCString& rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
 std::ostream& operator<< (std::ostream& os, const ThreadSafeRCString& str);
\ No newline at end of file